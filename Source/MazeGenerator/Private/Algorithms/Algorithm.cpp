@@ -1,6 +1,12 @@
 ﻿// Copyright LowkeyMe. All Rights Reserved. 2022
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
+
+#include "DisjointSet.h"
+#include "MazeStats.h"
+#include "Utils.h"
+
+#include "Async/ParallelFor.h"
 
 EDirection OppositeDirection(const EDirection Direction)
 {
@@ -45,47 +51,164 @@ int32 DirectionDY(const EDirection Direction)
 	}
 }
 
-TArray<TArray<uint8>> Algorithm::GetGrid(const FIntVector2& Size, const int32 Seed)
+FMazePassages Algorithm::GetPassages(const FIntVector2& Size, const int32 Seed,
+                                    const FGenerationOptions& Options) const
 {
-	// There is for each 2 not connected floors 1 wall between.
-	const FIntVector2 DirectionsGridSize((Size.X + 1) / 2, (Size.Y + 1) / 2);
+	FMazePassages Passages(Size);
 
 	const FRandomStream RandomStream(Seed);
 
-	const TArray<TArray<uint8>> DirectionsGrid = GetDirectionsGrid(DirectionsGridSize, RandomStream);
+	// Directions grid is released as soon as it is packed.
+	const FIntVector2 DirectionsGridSize(Passages.GetWidth(), Passages.GetHeight());
+	// Tiles thinner than 2 cells can't be generated by some algorithms.
+	const int32 TileSize = Options.TileSize > 0 ? FMath::Max(Options.TileSize, 2) : 0;
 
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
-
-	for (int32 Y = 0; Y < DirectionsGridSize.Y; ++Y)
+	FMazeGrid DirectionsGrid;
 	{
-		for (int32 X = 0; X < DirectionsGridSize.X; ++X)
+		SCOPE_CYCLE_COUNTER(STAT_MazeGenerateDirections);
+
+		if (TileSize && (DirectionsGridSize.X >= TileSize * 2 || DirectionsGridSize.Y >= TileSize * 2))
+		{
+			DirectionsGrid = GetTiledDirectionsGrid(DirectionsGridSize, RandomStream, TileSize, Options.bCancelled);
+		}
+		else if (Options.bParallel)
+		{
+			DirectionsGrid = GetDirectionsGridParallel(DirectionsGridSize, RandomStream, Options.bCancelled);
+		}
+		else
 		{
-			Grid[Y * 2][X * 2] = 1;
+			DirectionsGrid = GetDirectionsGrid(DirectionsGridSize, RandomStream, Options.bCancelled);
+		}
+	}
 
-			//It only makes sense to check the western and northern directions,
-			//because the remaining ones would simply overlap.
+	if (IsCancelled(Options.bCancelled))
+	{
+		return FMazePassages();
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MazePackPassages);
+	for (int32 Y = 0; Y < Passages.GetHeight(); ++Y)
+	{
+		for (int32 X = 0; X < Passages.GetWidth(); ++X)
+		{
+			// It only makes sense to check the eastern and southern directions,
+			// because the remaining ones are stored in the neighbouring cells.
 
-			if (DirectionsGrid[Y][X] & static_cast<uint8>(EDirection::West))
+			if (DirectionsGrid(X, Y) & static_cast<uint8>(EDirection::East))
 			{
-				Grid[Y * 2][X * 2 - 1] = 1;
+				Passages.OpenEast(X, Y);
 			}
-			if (DirectionsGrid[Y][X] & static_cast<uint8>(EDirection::North))
+			if (DirectionsGrid(X, Y) & static_cast<uint8>(EDirection::South))
 			{
-				Grid[Y * 2 - 1][X * 2] = 1;
+				Passages.OpenSouth(X, Y);
 			}
 		}
 	}
 
-	return Grid;
+	return Passages;
+}
+
+FMazeGrid Algorithm::GetGrid(const FIntVector2& Size, const int32 Seed, const FGenerationOptions& Options) const
+{
+	return GetPassages(Size, Seed, Options).ToGrid();
+}
+
+FMazeGrid Algorithm::GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                               const std::atomic<bool>* bCancelled) const
+{
+	return GetDirectionsGrid(Size, RandomStream, bCancelled);
 }
 
-TArray<TArray<uint8>> Algorithm::CreateZeroedGrid(const FIntVector2& Size)
+FMazeGrid Algorithm::GetTiledDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                            const int32 TileSize, const std::atomic<bool>* bCancelled) const
 {
-	TArray<TArray<uint8>> Grid;
-	Grid.Init(TArray<uint8>(), Size.Y);
-	for (int32 Y = 0; Y < Size.Y; ++Y)
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	// Remainder is spread between tiles, so no tile is thinner than TileSize.
+	const FIntVector2 TilesAmount(FMath::Max(Size.X / TileSize, 1), FMath::Max(Size.Y / TileSize, 1));
+	auto TileStartX = [&](const int32 TileX) { return TileX * Size.X / TilesAmount.X; };
+	auto TileStartY = [&](const int32 TileY) { return TileY * Size.Y / TilesAmount.Y; };
+
+	const uint32 BaseSeed = RandomStream.GetUnsignedInt();
+
+	ParallelFor(TilesAmount.X * TilesAmount.Y, [&](const int32 Tile)
+	{
+		if (IsCancelled(bCancelled))
+		{
+			return;
+		}
+
+		const int32 TileX = Tile % TilesAmount.X;
+		const int32 TileY = Tile / TilesAmount.X;
+		const int32 StartX = TileStartX(TileX);
+		const int32 StartY = TileStartY(TileY);
+		const FIntVector2 TileGridSize(TileStartX(TileX + 1) - StartX, TileStartY(TileY + 1) - StartY);
+
+		// Seed depends only on tile index, so the result doesn't depend on amount of cores.
+		const FRandomStream TileRandomStream(static_cast<int32>(HashCombineFast(BaseSeed, GetTypeHash(Tile))));
+		const FMazeGrid TileGrid = GetDirectionsGrid(TileGridSize, TileRandomStream, bCancelled);
+
+		for (int32 Y = 0; Y < TileGridSize.Y; ++Y)
+		{
+			FMemory::Memcpy(Grid[StartY + Y].GetData() + StartX, TileGrid[Y].GetData(), TileGridSize.X);
+		}
+	});
+
+	// Random spanning tree of tiles: edge is encoded as tile index * 2 + 0 for eastern and + 1 for southern edge.
+	TArray<int32> Edges;
+	Edges.Reserve((TilesAmount.X - 1) * TilesAmount.Y + TilesAmount.X * (TilesAmount.Y - 1));
+	for (int32 TileY = 0; TileY < TilesAmount.Y; ++TileY)
+	{
+		for (int32 TileX = 0; TileX < TilesAmount.X; ++TileX)
+		{
+			const int32 Tile = TileY * TilesAmount.X + TileX;
+			if (TileX + 1 < TilesAmount.X)
+			{
+				Edges.Add(Tile * 2);
+			}
+			if (TileY + 1 < TilesAmount.Y)
+			{
+				Edges.Add(Tile * 2 + 1);
+			}
+		}
+	}
+	ShuffleTArray(Edges, RandomStream);
+
+	FDisjointSet Tiles(TilesAmount.X * TilesAmount.Y);
+	for (const int32 Edge : Edges)
 	{
-		Grid[Y].SetNumZeroed(Size.X);
+		const int32 Tile = Edge / 2;
+		const int32 TileX = Tile % TilesAmount.X;
+		const int32 TileY = Tile / TilesAmount.X;
+		const bool bIsEastern = !(Edge & 1);
+		const int32 NextTile = bIsEastern ? Tile + 1 : Tile + TilesAmount.X;
+
+		if (!Tiles.Union(Tile, NextTile))
+		{
+			continue;
+		}
+
+		// Open a random passage through the border between tiles.
+		if (bIsEastern)
+		{
+			const int32 X = TileStartX(TileX + 1) - 1;
+			const int32 Y = RandomStream.RandRange(TileStartY(TileY), TileStartY(TileY + 1) - 1);
+			Grid(X, Y) |= static_cast<uint8>(EDirection::East);
+			Grid(X + 1, Y) |= static_cast<uint8>(EDirection::West);
+		}
+		else
+		{
+			const int32 X = RandomStream.RandRange(TileStartX(TileX), TileStartX(TileX + 1) - 1);
+			const int32 Y = TileStartY(TileY + 1) - 1;
+			Grid(X, Y) |= static_cast<uint8>(EDirection::South);
+			Grid(X, Y + 1) |= static_cast<uint8>(EDirection::North);
+		}
 	}
+
 	return Grid;
-}	
+}
+
+FMazeGrid Algorithm::CreateZeroedGrid(const FIntVector2& Size)
+{
+	return FMazeGrid(Size);
+}
@@ -2,37 +2,70 @@
 
 #include "Backtracker.h"
 
+#include "MazeStats.h"
+
 #include "Utils.h"
 
-TArray<TArray<uint8>> Backtracker::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
+FMazeGrid Backtracker::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                         const std::atomic<bool>* bCancelled) const
 {
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	TRACE_CPUPROFILER_EVENT_SCOPE(Backtracker::GetDirectionsGrid);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
 
-	CarvePassagesFrom(0, 0, Grid, RandomStream);
+	CarvePassagesFrom(0, 0, Grid, RandomStream, bCancelled);
 
 	return Grid;
 }
 
-void Backtracker::CarvePassagesFrom(const int32 X, const int32 Y, TArray<TArray<uint8>>& Grid,
-                                    const FRandomStream& RandomStream)
+void Backtracker::CarvePassagesFrom(const int32 X, const int32 Y, FMazeGrid& Grid,
+                                    const FRandomStream& RandomStream, const std::atomic<bool>* bCancelled)
 {
-	const TArray<EDirection> Directions = ShuffleTArray<EDirection>(
-		TArray{
-			EDirection::West, EDirection::East,
-			EDirection::North, EDirection::South
-		}, RandomStream);
+	// Explicit stack replaces recursion, which could be millions of calls deep on large mazes.
+	TArray<FCarveFrame> Stack;
 
-	for (int i = 0; i < Directions.Num(); ++i)
+	auto Push = [&Stack, &RandomStream](const int32 Cell)
 	{
-		const EDirection Direction = Directions[i];
-		const int32 NextX = X + DirectionDX(Direction);
-		const int32 NextY = Y + DirectionDY(Direction);
-		const bool bInBounds = NextY >= 0 && NextX >= 0 && NextY < Grid.Num() && NextX < Grid[Y].Num();
-		if (bInBounds && Grid[NextY][NextX] == 0)
+		// Shuffle happens on entering a cell, exactly as the recursive version did, so the same seed gives the same maze.
+		uint8 Order[DirectionsAmount] = {0, 1, 2, 3};
+		ShuffleArray(Order, RandomStream);
+
+		FCarveFrame& Frame = Stack.AddDefaulted_GetRef();
+		Frame.Cell = Cell;
+		Frame.Order = static_cast<uint8>(Order[0] | Order[1] << 2 | Order[2] << 4 | Order[3] << 6);
+		Frame.Next = 0;
+	};
+
+	Push(Grid.ToIndex(X, Y));
+
+	for (int32 Step = 1; !Stack.IsEmpty(); ++Step)
+	{
+		if (Step % CancelCheckInterval == 0 && IsCancelled(bCancelled))
+		{
+			return;
+		}
+
+		FCarveFrame& Frame = Stack.Last();
+		if (Frame.Next == DirectionsAmount)
+		{
+			Stack.Pop(EAllowShrinking::No);
+			continue;
+		}
+
+		const EDirection Direction = Directions[(Frame.Order >> Frame.Next * 2) & 3];
+		++Frame.Next;
+
+		const int32 CellX = Frame.Cell % Grid.GetWidth();
+		const int32 CellY = Frame.Cell / Grid.GetWidth();
+		const int32 NextX = CellX + DirectionDX(Direction);
+		const int32 NextY = CellY + DirectionDY(Direction);
+		const bool bInBounds = NextY >= 0 && NextX >= 0 && NextY < Grid.GetHeight() && NextX < Grid.GetWidth();
+		if (bInBounds && Grid(NextX, NextY) == 0)
 		{
-			Grid[Y][X] |= static_cast<uint8>(Direction);
-			Grid[NextY][NextX] |= static_cast<uint8>(OppositeDirection(Direction));
-			CarvePassagesFrom(NextX, NextY, Grid, RandomStream);
+			Grid(CellX, CellY) |= static_cast<uint8>(Direction);
+			Grid(NextX, NextY) |= static_cast<uint8>(OppositeDirection(Direction));
+			// Frame reference is invalidated here.
+			Push(Grid.ToIndex(NextX, NextY));
 		}
 	}
 }
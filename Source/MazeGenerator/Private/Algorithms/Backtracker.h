@@ -4,7 +4,19 @@
 
 #include "CoreMinimal.h"
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
+
+// State of a single cell being carved: the cell and the permutation of directions left to try.
+struct FCarveFrame
+{
+	int32 Cell;
+
+	// 4 directions, 2 bits each.
+	uint8 Order;
+
+	// Index of the next direction in Order.
+	uint8 Next;
+};
 
 class Backtracker : public Algorithm
 {
@@ -12,9 +24,17 @@ public:
 	virtual ~Backtracker() override = default;
 
 private:
-	virtual TArray<TArray<uint8>> GetDirectionsGrid(const FIntVector2& Size,
-	                                                const FRandomStream& RandomStream) override;
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
+
+	static void CarvePassagesFrom(const int32 X, const int32 Y, FMazeGrid& Grid,
+	                              const FRandomStream& RandomStream, const std::atomic<bool>* bCancelled);
+
+	static constexpr int32 DirectionsAmount = 4;
 
-	void CarvePassagesFrom(const int32 X, const int32 Y, TArray<TArray<uint8>>& Grid,
-	                       const FRandomStream& RandomStream);
+	// Order of directions before shuffle.
+	static constexpr EDirection Directions[DirectionsAmount] = {
+		EDirection::West, EDirection::East,
+		EDirection::North, EDirection::South
+	};
 };
@@ -0,0 +1,93 @@
+﻿// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#include "BinaryTree.h"
+
+#include "MazeStats.h"
+
+#include "Async/ParallelFor.h"
+
+FMazeGrid BinaryTree::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                        const std::atomic<bool>* bCancelled) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(BinaryTree::GetDirectionsGrid);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	const uint32 Seed = RandomStream.GetUnsignedInt();
+	for (int32 Y = 0; Y < Size.Y && !IsCancelled(bCancelled); ++Y)
+	{
+		GenerateRow(Grid, Y, Seed);
+	}
+
+	return Grid;
+}
+
+FMazeGrid BinaryTree::GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                                const std::atomic<bool>* bCancelled) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(BinaryTree::GetDirectionsGridParallel);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	const uint32 Seed = RandomStream.GetUnsignedInt();
+	ParallelFor(Size.Y, [&Grid, Seed, bCancelled](const int32 Y)
+	{
+		if (!IsCancelled(bCancelled))
+		{
+			GenerateRow(Grid, Y, Seed);
+		}
+	});
+
+	return Grid;
+}
+
+void BinaryTree::GenerateRow(FMazeGrid& Grid, const int32 Y, const uint32 Seed)
+{
+	const int32 Width = Grid.GetWidth();
+	const int32 Height = Grid.GetHeight();
+	const TArrayView<uint8> Row = Grid[Y];
+	const int32 RowStart = Y * Width;
+
+	constexpr uint8 North = static_cast<uint8>(EDirection::North);
+	constexpr uint8 West = static_cast<uint8>(EDirection::West);
+	constexpr uint8 East = static_cast<uint8>(EDirection::East);
+	constexpr uint8 South = static_cast<uint8>(EDirection::South);
+
+	// Cells on the top row can only go west, on the left column only north.
+	auto Choose = [Seed](const int32 X, const int32 CellY, const int32 Index) -> uint8
+	{
+		if (CellY == 0)
+		{
+			return X == 0 ? 0 : West;
+		}
+		if (X == 0)
+		{
+			return North;
+		}
+		return ChoosesNorth(Index, Seed) ? North : West;
+	};
+
+	for (int32 X = 0; X < Width; ++X)
+	{
+		const int32 Index = RowStart + X;
+
+		uint8 Directions = Choose(X, Y, Index);
+		// Eastern neighbour connected to the west and southern one connected to the north open this cell too.
+		Directions |= X + 1 < Width && Choose(X + 1, Y, Index + 1) == West ? East : 0;
+		Directions |= Y + 1 < Height && Choose(X, Y + 1, Index + Width) == North ? South : 0;
+
+		Row[X] = Directions;
+	}
+}
+
+bool BinaryTree::ChoosesNorth(const int32 Index, const uint32 Seed)
+{
+	// Murmur3 finalizer.
+	uint32 Hash = static_cast<uint32>(Index) ^ Seed;
+	Hash ^= Hash >> 16;
+	Hash *= 0x85ebca6b;
+	Hash ^= Hash >> 13;
+	Hash *= 0xc2b2ae35;
+	Hash ^= Hash >> 16;
+	return Hash & 1;
+}
@@ -0,0 +1,33 @@
+﻿// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Algorithms/Algorithm.h"
+
+
+/**
+ * Every cell is connected either to the northern or to the western neighbour.
+ * 
+ * Choice of a cell depends only on seed and cell index, so each cell computes all 4 of its directions
+ * without reading other cells. Rows are generated in parallel and inner loop is branch-light and vectorizable.
+ * Parallel and serial generation give the same maze.
+ */
+class BinaryTree : public Algorithm
+{
+public:
+	virtual ~BinaryTree() override = default;
+
+private:
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
+
+	virtual FMazeGrid GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                            const std::atomic<bool>* bCancelled) const override;
+
+	static void GenerateRow(FMazeGrid& Grid, const int32 Y, const uint32 Seed);
+
+	// Whether the cell is connected to the north, otherwise it's connected to the west.
+	static FORCEINLINE bool ChoosesNorth(const int32 Index, const uint32 Seed);
+};
@@ -0,0 +1,52 @@
+﻿// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#include "DisjointSet.h"
+
+FDisjointSet::FDisjointSet(const int32 Num)
+{
+	Parents.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; ++i)
+	{
+		Parents[i] = i;
+	}
+	Ranks.SetNumZeroed(Num);
+}
+
+int32 FDisjointSet::Find(int32 Element)
+{
+	int32 Root = Element;
+	while (Parents[Root] != Root)
+	{
+		Root = Parents[Root];
+	}
+
+	// Path compression.
+	while (Parents[Element] != Root)
+	{
+		const int32 Next = Parents[Element];
+		Parents[Element] = Root;
+		Element = Next;
+	}
+	return Root;
+}
+
+bool FDisjointSet::Union(const int32 First, const int32 Second)
+{
+	int32 FirstRoot = Find(First);
+	int32 SecondRoot = Find(Second);
+	if (FirstRoot == SecondRoot)
+	{
+		return false;
+	}
+
+	if (Ranks[FirstRoot] < Ranks[SecondRoot])
+	{
+		Swap(FirstRoot, SecondRoot);
+	}
+	Parents[SecondRoot] = FirstRoot;
+	if (Ranks[FirstRoot] == Ranks[SecondRoot])
+	{
+		++Ranks[FirstRoot];
+	}
+	return true;
+}
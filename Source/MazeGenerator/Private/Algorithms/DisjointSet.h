@@ -0,0 +1,22 @@
+﻿// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Flat disjoint-set forest over cell indices with path compression and union by rank.
+class FDisjointSet
+{
+public:
+	explicit FDisjointSet(const int32 Num);
+
+	int32 Find(int32 Element);
+
+	// Returns false if elements are already in the same set.
+	bool Union(const int32 First, const int32 Second);
+
+private:
+	TArray<int32> Parents;
+
+	TArray<uint8> Ranks;
+};
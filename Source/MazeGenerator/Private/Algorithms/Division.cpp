@@ -2,28 +2,126 @@
 
 #include "Division.h"
 
-TArray<TArray<uint8>> Division::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
+#include "MazeStats.h"
+
+#include "Tasks/Task.h"
+
+FMazeGrid Division::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                      const std::atomic<bool>* bCancelled) const
 {
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	TRACE_CPUPROFILER_EVENT_SCOPE(Division::GetDirectionsGrid);
 
-	Divide(Grid, 0, 0, Size, RandomStream, EDivisionOrientation::Horizontal);
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	DivideIteratively(Grid, FDivisionArea{0, 0, Size, EDivisionOrientation::Horizontal}, RandomStream, bCancelled);
 
 	return Grid;
 }
 
-void Division::Divide(TArray<TArray<uint8>>& Grid,
-                      const int32 X, const int32 Y,
-                      const FIntVector2& Size,
-                      const FRandomStream& RandomStream,
-                      EDivisionOrientation Orientation)
+FMazeGrid Division::GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                              const std::atomic<bool>* bCancelled) const
 {
-	if (Size.X < 2 || Size.Y < 2)
+	TRACE_CPUPROFILER_EVENT_SCOPE(Division::GetDirectionsGridParallel);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	DivideParallel(Grid, FDivisionArea{0, 0, Size, EDivisionOrientation::Horizontal},
+	               static_cast<int32>(RandomStream.GetUnsignedInt()), bCancelled);
+
+	return Grid;
+}
+
+void Division::DivideIteratively(FMazeGrid& Grid, const FDivisionArea& Area, const FRandomStream& RandomStream,
+                                 const std::atomic<bool>* bCancelled)
+{
+	TArray<FDivisionArea> Stack;
+	Stack.Push(Area);
+
+	for (int32 Step = 1; !Stack.IsEmpty(); ++Step)
+	{
+		if (Step % CancelCheckInterval == 0 && IsCancelled(bCancelled))
+		{
+			return;
+		}
+
+		FDivisionArea Current = Stack.Pop(EAllowShrinking::No);
+
+		// Orientation is chosen right before the area is divided, as it was done by recursive calls,
+		// so random values are drawn in the same order.
+		if (Current.Orientation == EDivisionOrientation::None)
+		{
+			Current.Orientation = ChooseOrientation(Current.Size, RandomStream);
+		}
+
+		FDivisionArea First;
+		FDivisionArea Second;
+		if (Divide(Grid, Current, RandomStream, First, Second))
+		{
+			// The first area has to be processed first.
+			Stack.Push(Second);
+			Stack.Push(First);
+		}
+	}
+}
+
+void Division::DivideParallel(FMazeGrid& Grid, FDivisionArea Area, const int32 Seed,
+                              const std::atomic<bool>* bCancelled)
+{
+	const FRandomStream RandomStream(Seed);
+
+	if (Area.Size.X * Area.Size.Y < ParallelAreaThreshold)
 	{
+		DivideIteratively(Grid, Area, RandomStream, bCancelled);
 		return;
 	}
 
+	if (IsCancelled(bCancelled))
+	{
+		return;
+	}
+
+	if (Area.Orientation == EDivisionOrientation::None)
+	{
+		Area.Orientation = ChooseOrientation(Area.Size, RandomStream);
+	}
+
+	FDivisionArea First;
+	FDivisionArea Second;
+	if (!Divide(Grid, Area, RandomStream, First, Second))
+	{
+		return;
+	}
+
+	// Each subtree has its own stream derived from the parent one,
+	// so the result doesn't depend on the order tasks are executed in.
+	const int32 FirstSeed = static_cast<int32>(RandomStream.GetUnsignedInt());
+	const int32 SecondSeed = static_cast<int32>(RandomStream.GetUnsignedInt());
+
+	// Areas are disjoint, so they can be divided concurrently.
+	const UE::Tasks::FTask FirstTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Grid, First, FirstSeed, bCancelled]
+	{
+		DivideParallel(Grid, First, FirstSeed, bCancelled);
+	});
+
+	DivideParallel(Grid, Second, SecondSeed, bCancelled);
+
+	FirstTask.Wait();
+}
+
+bool Division::Divide(FMazeGrid& Grid, const FDivisionArea& Area, const FRandomStream& RandomStream,
+                      FDivisionArea& OutFirst, FDivisionArea& OutSecond)
+{
+	const int32 X = Area.X;
+	const int32 Y = Area.Y;
+	const FIntVector2& Size = Area.Size;
+
+	if (Size.X < 2 || Size.Y < 2)
+	{
+		return false;
+	}
+
 
-	const bool bIsHorizontal = Orientation == EDivisionOrientation::Horizontal;
+	const bool bIsHorizontal = Area.Orientation == EDivisionOrientation::Horizontal;
 	const int32 Dx = bIsHorizontal ? 1 : 0;
 	const int32 Dy = bIsHorizontal ? 0 : 1;
 
@@ -70,21 +168,19 @@ void Division::Divide(TArray<TArray<uint8>>& Grid,
 	}
 
 
-	FIntVector2 NextSize;
-
-	int32 NextX = X;
-	int32 NextY = Y;
-	NextSize.X = bIsHorizontal ? Size.X : WallX - X + 1;
-	NextSize.Y = bIsHorizontal ? WallY - Y + 1 : Size.Y;
-
-	Divide(Grid, NextX, NextY, NextSize, RandomStream, ChooseOrientation(NextSize, RandomStream));
+	OutFirst.X = X;
+	OutFirst.Y = Y;
+	OutFirst.Size.X = bIsHorizontal ? Size.X : WallX - X + 1;
+	OutFirst.Size.Y = bIsHorizontal ? WallY - Y + 1 : Size.Y;
+	OutFirst.Orientation = EDivisionOrientation::None;
 
-	NextX = bIsHorizontal ? X : WallX + 1;
-	NextY = bIsHorizontal ? WallY + 1 : Y;
-	NextSize.X = bIsHorizontal ? Size.X : X + Size.X - WallX - 1;
-	NextSize.Y = bIsHorizontal ? Y + Size.Y - WallY - 1 : Size.Y;
+	OutSecond.X = bIsHorizontal ? X : WallX + 1;
+	OutSecond.Y = bIsHorizontal ? WallY + 1 : Y;
+	OutSecond.Size.X = bIsHorizontal ? Size.X : X + Size.X - WallX - 1;
+	OutSecond.Size.Y = bIsHorizontal ? Y + Size.Y - WallY - 1 : Size.Y;
+	OutSecond.Orientation = EDivisionOrientation::None;
 
-	Divide(Grid, NextX, NextY, NextSize, RandomStream, ChooseOrientation(NextSize, RandomStream));
+	return true;
 }
 
 EDivisionOrientation Division::ChooseOrientation(const FIntVector2& Size, const FRandomStream& RandomStream)
@@ -2,7 +2,7 @@
 
 #pragma once
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
 
 
 enum class EDivisionOrientation: uint8
@@ -13,20 +13,44 @@ enum class EDivisionOrientation: uint8
 };
 
 
+// Area to be divided.
+struct FDivisionArea
+{
+	int32 X;
+	int32 Y;
+	FIntVector2 Size;
+
+	// None if it has to be chosen right before the division.
+	EDivisionOrientation Orientation;
+};
+
+
 class Division : public Algorithm
 {
 public:
 	virtual ~Division() override = default;
 
 private:
-	virtual TArray<TArray<uint8>> GetDirectionsGrid(const FIntVector2& Size,
-	                                                const FRandomStream& RandomStream) override;
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
 
-	void Divide(TArray<TArray<uint8>>& Grid,
-	            const int32 X, const int32 Y,
-	            const FIntVector2& Size,
-	            const FRandomStream& RandomStream,
-	            EDivisionOrientation Orientation);
+	virtual FMazeGrid GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                            const std::atomic<bool>* bCancelled) const override;
+
+	// Divides the area and all its sub-areas using explicit stack instead of recursion.
+	static void DivideIteratively(FMazeGrid& Grid, const FDivisionArea& Area, const FRandomStream& RandomStream,
+	                              const std::atomic<bool>* bCancelled);
+
+	// Divides areas larger than ParallelAreaThreshold in separate tasks, the smaller ones iteratively.
+	static void DivideParallel(FMazeGrid& Grid, FDivisionArea Area, const int32 Seed,
+	                           const std::atomic<bool>* bCancelled);
+
+	// Places a wall with a passage across the area. Returns false if the area is too small to be divided.
+	static bool Divide(FMazeGrid& Grid, const FDivisionArea& Area, const FRandomStream& RandomStream,
+	                   FDivisionArea& OutFirst, FDivisionArea& OutSecond);
 
 	static EDivisionOrientation ChooseOrientation(const FIntVector2& Size, const FRandomStream& RandomStream);
+
+	// Minimal area in cells worth dividing in a separate task.
+	static constexpr int32 ParallelAreaThreshold = 128 * 128;
 };
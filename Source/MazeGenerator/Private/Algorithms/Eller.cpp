@@ -1,38 +1,50 @@
 ﻿// Copyright LowkeyMe. All Rights Reserved. 2022
 
-#include "Eller.h"
+#include "Algorithms/Eller.h"
 
-TArray<TArray<uint8>> Eller::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
+#include "MazeStats.h"
+
+FEllerRowGenerator::FEllerRowGenerator(const int32 InWidth, const FRandomStream& InRandomStream)
+	: Width(InWidth), RandomStream(InRandomStream), SetsCounter(0), RowsAmount(0), bIsFinished(false)
 {
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	Row.SetNumZeroed(Width);
+	CurrentDirections.SetNumZeroed(Width);
+	NextDirections.SetNumZeroed(Width);
+}
 
-	TArray<uint32> Row;
-	Row.SetNumZeroed(Size.X);
+TArrayView<const uint8> FEllerRowGenerator::Next(const bool bIsLastRow)
+{
+	check(!bIsFinished);
 
-	uint32 SetsCounter = 0;
+	// North passages of this row were created while the previous one was generated.
+	Swap(CurrentDirections, NextDirections);
+	FMemory::Memzero(NextDirections.GetData(), Width);
+	++RowsAmount;
 
-	// Initialize all rows except last one.
-	for (int32 Y = 0; Y < Size.Y; ++Y)
+	// Every row takes at most Width new ids.
+	if (SetsCounter > static_cast<uint32>(MAX_int32 - Width))
 	{
-		for (int32 X = 0; X < Size.X; ++X)
-		{
-			if (!Row[X])
-			{
-				Row[X] = ++SetsCounter;
-			}
-		}
+		CompactSets();
+	}
 
-		if (Y == Size.Y - 1)
+	for (int32 X = 0; X < Width; ++X)
+	{
+		if (!Row[X])
 		{
-			break;
+			Row[X] = ++SetsCounter;
 		}
+	}
+
+	if (bIsLastRow)
+	{
+		bIsFinished = true;
 
-		for (int32 X = 0; X < Size.X - 1; ++X)
+		for (int X = 0; X < Width - 1; ++X)
 		{
-			if (Row[X] != Row[X + 1] && !RandomStream.RandRange(0, 1))
+			if (Row[X] != Row[X + 1])
 			{
-				Grid[Y][X] |= static_cast<uint8>(EDirection::East);
-				Grid[Y][X + 1] |= static_cast<uint8>(EDirection::West);
+				CurrentDirections[X] |= static_cast<uint8>(EDirection::East);
+				CurrentDirections[X + 1] |= static_cast<uint8>(EDirection::West);
 
 				const uint32 DissolvedSet = Row[X + 1];
 				do
@@ -40,70 +52,131 @@ TArray<TArray<uint8>> Eller::GetDirectionsGrid(const FIntVector2& Size, const FR
 					Row[X + 1] = Row[X];
 					X++;
 				}
-				while (X < Size.X - 1 && Row[X + 1] == DissolvedSet);
+				while (X < Width - 1 && Row[X + 1] == DissolvedSet);
+
+				// After this loop, X is the index of the last merged element,
+				// and then the outer loop will increment X, so it is needed to decrement once 
+				--X;
 			}
 		}
 
-		// Create vertical passages.
-		for (int32 PassagesCount = 0, CurrentSet,
-		           CellsAmount = 1, // For current set.
-		           X = 0; X < Size.X; ++X, ++CellsAmount)
+		return CurrentDirections;
+	}
+
+	for (int32 X = 0; X < Width - 1; ++X)
+	{
+		if (Row[X] != Row[X + 1] && !RandomStream.RandRange(0, 1))
 		{
-			CurrentSet = Row[X];
-			if (RandomStream.RandRange(0, 1))
-			{
-				++PassagesCount;
+			CurrentDirections[X] |= static_cast<uint8>(EDirection::East);
+			CurrentDirections[X + 1] |= static_cast<uint8>(EDirection::West);
 
-				Grid[Y][X] |= static_cast<uint8>(EDirection::South);
-				Grid[Y + 1][X] |= static_cast<uint8>(EDirection::North);
-			}
-			else
+			const uint32 DissolvedSet = Row[X + 1];
+			do
 			{
-				Row[X] = 0;
+				Row[X + 1] = Row[X];
+				X++;
 			}
+			while (X < Width - 1 && Row[X + 1] == DissolvedSet);
+		}
+	}
 
-			if (X == Size.X - 1 // If last cell. 
-				|| CurrentSet != Row[X + 1]) // If set is about to change.
-			{
-				//Ensure there at least one vertical passage in previous set.
-				if (!PassagesCount)
-				{
-					const int32 RandomX = RandomStream.RandRange(X - CellsAmount + 1, X);
+	// Create vertical passages.
+	for (int32 PassagesCount = 0, CurrentSet,
+	           CellsAmount = 1, // For current set.
+	           X = 0; X < Width; ++X, ++CellsAmount)
+	{
+		CurrentSet = Row[X];
+		if (RandomStream.RandRange(0, 1))
+		{
+			++PassagesCount;
 
-					Row[RandomX] = CurrentSet;
+			CurrentDirections[X] |= static_cast<uint8>(EDirection::South);
+			NextDirections[X] |= static_cast<uint8>(EDirection::North);
+		}
+		else
+		{
+			Row[X] = 0;
+		}
 
-					Grid[Y][RandomX] |= static_cast<uint8>(EDirection::South);
-					Grid[Y + 1][RandomX] |= static_cast<uint8>(EDirection::North);
-				}
+		if (X == Width - 1 // If last cell. 
+			|| CurrentSet != Row[X + 1]) // If set is about to change.
+		{
+			//Ensure there at least one vertical passage in previous set.
+			if (!PassagesCount)
+			{
+				const int32 RandomX = RandomStream.RandRange(X - CellsAmount + 1, X);
 
+				Row[RandomX] = CurrentSet;
 
-				PassagesCount = 0;
-				CellsAmount = 0;
+				CurrentDirections[RandomX] |= static_cast<uint8>(EDirection::South);
+				NextDirections[RandomX] |= static_cast<uint8>(EDirection::North);
 			}
+
+
+			PassagesCount = 0;
+			CellsAmount = 0;
 		}
 	}
 
-	// Create last row.
-	for (int X = 0; X < Size.X - 1; ++X)
+	return CurrentDirections;
+}
+
+void FEllerRowGenerator::CompactSets()
+{
+	TMap<uint32, uint32> NewSets;
+	NewSets.Reserve(Width);
+	SetsCounter = 0;
+	for (uint32& Set : Row)
 	{
-		if (Row[X] != Row[X + 1])
+		if (Set)
 		{
-			Grid[Size.Y - 1][X] |= static_cast<uint8>(EDirection::East);
-			Grid[Size.Y - 1][X + 1] |= static_cast<uint8>(EDirection::West);
-
-			const uint32 DissolvedSet = Row[X + 1];
-			do
+			uint32& NewSet = NewSets.FindOrAdd(Set);
+			if (!NewSet)
 			{
-				Row[X + 1] = Row[X];
-				X++;
+				NewSet = ++SetsCounter;
 			}
-			while (X < Size.X - 1 && Row[X + 1] == DissolvedSet);
+			Set = NewSet;
+		}
+	}
+}
+
+void Eller::GenerateRows(const int32 Width, const int32 Height, const FRandomStream& RandomStream,
+                         TFunctionRef<bool(int32, TArrayView<const uint8>)> Consumer)
+{
+	FEllerRowGenerator Generator(Width, RandomStream);
 
-			// After this loop, X is the index of the last merged element,
-			// and then the outer loop will increment X, so it is needed to decrement once 
-			--X;
+	bool bIsLastRow = Height == 1;
+	while (!Generator.IsFinished())
+	{
+		const int32 Y = Generator.GetRowsAmount();
+		const bool bShouldContinue = Consumer(Y, Generator.Next(bIsLastRow));
+		if (Height == INDEX_NONE)
+		{
+			bIsLastRow = !bShouldContinue;
+		}
+		else if (!bShouldContinue)
+		{
+			return;
+		}
+		else
+		{
+			bIsLastRow = Y + 2 == Height;
 		}
 	}
+}
+
+FMazeGrid Eller::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                   const std::atomic<bool>* bCancelled) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(Eller::GetDirectionsGrid);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	GenerateRows(Size.X, Size.Y, RandomStream, [&Grid, bCancelled](const int32 Y, const TArrayView<const uint8> Row)
+	{
+		FMemory::Memcpy(Grid[Y].GetData(), Row.GetData(), Row.Num());
+		return !IsCancelled(bCancelled);
+	});
 
 	return Grid;
 }
@@ -2,22 +2,102 @@
 
 #include "HaK.h"
 
+#include "MazeStats.h"
+
 #include "Utils.h"
 
-TArray<TArray<uint8>> HaK::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
+FHuntCandidates::FHuntCandidates(const FIntVector2& Size): Width(Size.X)
+{
+	Cells.Init(false, Size.X * Size.Y);
+	Rows.Init(false, Size.Y);
+	RowAmounts.SetNumZeroed(Size.Y);
+}
+
+void FHuntCandidates::OnVisited(const int32 X, const int32 Y, const FMazeGrid& Grid)
 {
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	Remove(X, Y);
+
+	if (X > 0 && Grid(X - 1, Y) == 0)
+	{
+		Add(X - 1, Y);
+	}
+	if (X + 1 < Grid.GetWidth() && Grid(X + 1, Y) == 0)
+	{
+		Add(X + 1, Y);
+	}
+	if (Y > 0 && Grid(X, Y - 1) == 0)
+	{
+		Add(X, Y - 1);
+	}
+	if (Y + 1 < Grid.GetHeight() && Grid(X, Y + 1) == 0)
+	{
+		Add(X, Y + 1);
+	}
+}
+
+TPair<int32, int32> FHuntCandidates::GetFirst() const
+{
+	const TConstSetBitIterator<> RowIt(Rows);
+	if (!RowIt)
+	{
+		return TPair<int32, int32>(-1, -1);
+	}
+	const int32 Y = RowIt.GetIndex();
+	const TConstSetBitIterator<> CellIt(Cells, Y * Width);
+	return TPair<int32, int32>(CellIt.GetIndex() - Y * Width, Y);
+}
+
+void FHuntCandidates::Add(const int32 X, const int32 Y)
+{
+	const int32 Index = Y * Width + X;
+	if (!Cells[Index])
+	{
+		Cells[Index] = true;
+		if (RowAmounts[Y]++ == 0)
+		{
+			Rows[Y] = true;
+		}
+	}
+}
+
+void FHuntCandidates::Remove(const int32 X, const int32 Y)
+{
+	const int32 Index = Y * Width + X;
+	if (Cells[Index])
+	{
+		Cells[Index] = false;
+		if (--RowAmounts[Y] == 0)
+		{
+			Rows[Y] = false;
+		}
+	}
+}
+
+FMazeGrid HaK::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                 const std::atomic<bool>* bCancelled) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(HaK::GetDirectionsGrid);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	FHuntCandidates Candidates(Size);
 
 	const int32 RandomX = RandomStream.RandRange(0, Size.X - 1);
 	const int32 RandomY = RandomStream.RandRange(0, Size.Y - 1);
 
 	TPair<int32, int32> Cell(RandomX, RandomY);
+	int32 Step = 0;
 	do
 	{
-		Cell = Walk(Grid, Cell.Key, Cell.Value, RandomStream);
+		if (++Step % CancelCheckInterval == 0 && IsCancelled(bCancelled))
+		{
+			break;
+		}
+
+		Cell = Walk(Grid, Cell.Key, Cell.Value, RandomStream, Candidates);
 		if (Cell.Key == -1)
 		{
-			Cell = Hunt(Grid, RandomStream);
+			Cell = Hunt(Grid, RandomStream, Candidates);
 		}
 	}
 	while (Cell.Key != -1);
@@ -25,79 +105,91 @@ TArray<TArray<uint8>> HaK::GetDirectionsGrid(const FIntVector2& Size, const FRan
 	return Grid;
 }
 
-TPair<int32, int32> HaK::Walk(TArray<TArray<uint8>>& Grid,
+TPair<int32, int32> HaK::Walk(FMazeGrid& Grid,
                               const int32 X, const int32 Y,
-                              const FRandomStream& RandomStream)
+                              const FRandomStream& RandomStream,
+                              FHuntCandidates& Candidates)
 {
-	const TArray<EDirection> Directions = ShuffleTArray(
-		TArray{
-			EDirection::West, EDirection::East,
-			EDirection::North, EDirection::South
-		}, RandomStream);
+	EDirection Directions[] = {
+		EDirection::West, EDirection::East,
+		EDirection::North, EDirection::South
+	};
+	ShuffleArray(Directions, RandomStream);
 
-	for (int i = 0; i < Directions.Num(); ++i)
+	for (const EDirection Direction : Directions)
 	{
-		const EDirection Direction = Directions[i];
 		const int32 NextX = X + DirectionDX(Direction);
 		const int32 NextY = Y + DirectionDY(Direction);
-		const bool bInBounds = NextY >= 0 && NextX >= 0 && NextY < Grid.Num() && NextX < Grid[Y].Num();
-		if (bInBounds && Grid[NextY][NextX] == 0)
+		if (Grid.IsValidIndex(NextX, NextY) && Grid(NextX, NextY) == 0)
 		{
-			Grid[Y][X] |= static_cast<uint8>(Direction);
-			Grid[NextY][NextX] |= static_cast<uint8>(OppositeDirection(Direction));
+			Carve(Grid, X, Y, Direction, Candidates);
 			return TPair<int32, int32>(NextX, NextY);
 		}
 	}
 	return TPair<int32, int32>(-1, -1);
 }
 
-TPair<int32, int32> HaK::Hunt(TArray<TArray<uint8>>& Grid, const FRandomStream& RandomStream)
+TPair<int32, int32> HaK::Hunt(FMazeGrid& Grid, const FRandomStream& RandomStream, FHuntCandidates& Candidates)
 {
-	for (int32 Y = 0; Y < Grid.Num(); ++Y)
+	// The first not visited cell next to a visited one in row-major order,
+	// which is the same cell full scan of the grid would find.
+	const TPair<int32, int32> Cell = Candidates.GetFirst();
+	if (Cell.Key == -1)
 	{
-		for (int32 X = 0; X < Grid[Y].Num(); ++X)
-		{
-			if (Grid[Y][X] != 0)
-			{
-				continue;
-			}
-			const TArray<EDirection> PossibleDirections = GetNeighbours(X, Y, Grid);
-			if (PossibleDirections.Num() == 0)
-			{
-				continue;
-			}
-			const EDirection ConnectDirection = PossibleDirections[RandomStream.RandRange(
-				0, PossibleDirections.Num() - 1)];
-			const int32 NextX = X + DirectionDX(ConnectDirection);
-			const int32 NextY = Y + DirectionDY(ConnectDirection);
-
-			Grid[Y][X] |= static_cast<uint8>(ConnectDirection);
-			Grid[NextY][NextX] |= static_cast<uint8>(OppositeDirection(ConnectDirection));
-
-			return TPair<int32, int32>(X, Y);
-		}
+		return Cell;
+	}
+
+	EDirection PossibleDirections[4];
+	const int32 PossibleDirectionsAmount = GetNeighbours(Cell.Key, Cell.Value, Grid, PossibleDirections);
+	check(PossibleDirectionsAmount > 0);
+
+	const EDirection ConnectDirection = PossibleDirections[RandomStream.RandRange(0, PossibleDirectionsAmount - 1)];
+
+	Carve(Grid, Cell.Key, Cell.Value, ConnectDirection, Candidates);
+
+	return Cell;
+}
+
+void HaK::Carve(FMazeGrid& Grid, const int32 X, const int32 Y, const EDirection Direction,
+                FHuntCandidates& Candidates)
+{
+	const int32 NextX = X + DirectionDX(Direction);
+	const int32 NextY = Y + DirectionDY(Direction);
+
+	const bool bWasVisited = Grid(X, Y) != 0;
+	const bool bNextWasVisited = Grid(NextX, NextY) != 0;
+
+	Grid(X, Y) |= static_cast<uint8>(Direction);
+	Grid(NextX, NextY) |= static_cast<uint8>(OppositeDirection(Direction));
+
+	if (!bWasVisited)
+	{
+		Candidates.OnVisited(X, Y, Grid);
+	}
+	if (!bNextWasVisited)
+	{
+		Candidates.OnVisited(NextX, NextY, Grid);
 	}
-	return TPair<int32, int32>(-1, -1);
 }
 
-TArray<EDirection> HaK::GetNeighbours(const int32 X, const int32 Y, const TArray<TArray<uint8>>& Grid)
+int32 HaK::GetNeighbours(const int32 X, const int32 Y, const FMazeGrid& Grid, EDirection (&OutDirections)[4])
 {
-	TArray<EDirection> Directions;
-	if (X > 0 && Grid[Y][X - 1])
+	int32 Amount = 0;
+	if (X > 0 && Grid(X - 1, Y))
 	{
-		Directions.Emplace(EDirection::West);
+		OutDirections[Amount++] = EDirection::West;
 	}
-	if (X + 1 < Grid[Y].Num() && Grid[Y][X + 1])
+	if (X + 1 < Grid.GetWidth() && Grid(X + 1, Y))
 	{
-		Directions.Emplace(EDirection::East);
+		OutDirections[Amount++] = EDirection::East;
 	}
-	if (Y > 0 && Grid[Y - 1][X])
+	if (Y > 0 && Grid(X, Y - 1))
 	{
-		Directions.Emplace(EDirection::North);
+		OutDirections[Amount++] = EDirection::North;
 	}
-	if (Y + 1 < Grid.Num() && Grid[Y + 1][X])
+	if (Y + 1 < Grid.GetHeight() && Grid(X, Y + 1))
 	{
-		Directions.Emplace(EDirection::South);
+		OutDirections[Amount++] = EDirection::South;
 	}
-	return Directions;
+	return Amount;
 }
@@ -4,22 +4,58 @@
 
 #include "CoreMinimal.h"
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
 
 
+/**
+ * Not visited cells adjacent to visited ones, i.e. cells the hunt phase may connect.
+ *
+ * Rows are tracked separately, so the first candidate is found without rescanning the whole grid.
+ */
+class FHuntCandidates
+{
+public:
+	explicit FHuntCandidates(const FIntVector2& Size);
+
+	// Must be called once the cell stops being zero in Grid.
+	void OnVisited(const int32 X, const int32 Y, const FMazeGrid& Grid);
+
+	// Returns the first candidate in row-major order or (-1, -1) if there are none.
+	TPair<int32, int32> GetFirst() const;
+
+private:
+	void Add(const int32 X, const int32 Y);
+
+	void Remove(const int32 X, const int32 Y);
+
+	int32 Width;
+
+	TBitArray<> Cells;
+
+	// Rows with at least one candidate.
+	TBitArray<> Rows;
+
+	TArray<int32> RowAmounts;
+};
+
 class HaK : public Algorithm
 {
 public:
 	virtual ~HaK() override = default;
 
 private:
-	virtual TArray<TArray<uint8>> GetDirectionsGrid(const FIntVector2& Size,
-	                                                const FRandomStream& RandomStream) override;
-	static TPair<int32, int32> Walk(TArray<TArray<uint8>>& Grid,
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
+	static TPair<int32, int32> Walk(FMazeGrid& Grid,
 	                                const int32 X, const int32 Y,
-	                                const FRandomStream& RandomStream);
+	                                const FRandomStream& RandomStream,
+	                                FHuntCandidates& Candidates);
+
+	static TPair<int32, int32> Hunt(FMazeGrid& Grid, const FRandomStream& RandomStream, FHuntCandidates& Candidates);
 
-	static TPair<int32, int32> Hunt(TArray<TArray<uint8>>& Grid, const FRandomStream& RandomStream);
+	static void Carve(FMazeGrid& Grid, const int32 X, const int32 Y, const EDirection Direction,
+	                  FHuntCandidates& Candidates);
 
-	static TArray<EDirection> GetNeighbours(const int32 X, const int32 Y, const TArray<TArray<uint8>>& Grid);
+	// Writes directions to visited neighbours and returns their amount.
+	static int32 GetNeighbours(const int32 X, const int32 Y, const FMazeGrid& Grid, EDirection (&OutDirections)[4]);
 };
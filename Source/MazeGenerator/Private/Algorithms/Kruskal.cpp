@@ -3,79 +3,58 @@
 
 #include "Kruskal.h"
 
-#include "Utils.h"
-
-Tree* Tree::GetRoot()
-{
-	if (Parent)
-	{
-		return Parent->GetRoot();
-	}
-	return this;
-}
+#include "MazeStats.h"
 
-bool Tree::IsConnected(Tree* const AnotherTree)
-{
-	if (GetRoot() == AnotherTree->GetRoot())
-	{
-		return true;
-	}
-	return false;
-}
+#include "Utils.h"
 
-void Tree::Connect(Tree* const TreeToConnect)
+FMazeGrid Kruskal::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                     const std::atomic<bool>* bCancelled) const
 {
-	TreeToConnect->GetRoot()->Parent = this;
-}
+	TRACE_CPUPROFILER_EVENT_SCOPE(Kruskal::GetDirectionsGrid);
 
-TArray<TArray<uint8>> Kruskal::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
-{
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	FMazeGrid Grid = CreateZeroedGrid(Size);
 
-	TArray<TArray<TSharedPtr<Tree>>> Trees;
-	Trees.SetNum(Size.Y);
-	for (int32 Y = 0; Y < Size.Y; ++Y)
-	{
-		Trees[Y] = TArray<TSharedPtr<Tree>>();
-		Trees[Y].SetNum(Size.X);
-		for (int32 X = 0; X < Size.X; ++X)
-		{
-			Trees[Y][X] = MakeShared<Tree>();
-		}
-	}
+	FDisjointSet Sets(Size.X * Size.Y);
 
-	TArray<FTreeEdge> Edges;
-	Edges.Reserve((Size.X - 1) * (Size.Y - 1));
+	// Edge is encoded as cell index * 2 + 0 for western and + 1 for northern edge.
+	TArray<int32> Edges;
+	Edges.Reserve((Size.X - 1) * Size.Y + Size.X * (Size.Y - 1));
 	for (int32 Y = 0; Y < Size.Y; ++Y)
 	{
 		for (int32 X = 0; X < Size.X; ++X)
 		{
+			const int32 Cell = Grid.ToIndex(X, Y);
 			if (X > 0)
 			{
-				Edges.Emplace(X, Y, EDirection::West);
+				Edges.Add(Cell * 2);
 			}
 			if (Y > 0)
 			{
-				Edges.Emplace(X, Y, EDirection::North);
+				Edges.Add(Cell * 2 + 1);
 			}
 		}
 	}
 
 	ShuffleTArray(Edges, RandomStream);
 
-	while (!Edges.IsEmpty())
+	for (int32 i = Edges.Num() - 1; i >= 0; --i)
 	{
-		const FTreeEdge CurrentEdge = Edges.Pop();
-		const TSharedPtr<Tree> CurrentTree = Trees[CurrentEdge.Y][CurrentEdge.X];
-		const int32 NextX = CurrentEdge.X + DirectionDX(CurrentEdge.Direction);
-		const int32 NextY = CurrentEdge.Y + DirectionDY(CurrentEdge.Direction);
+		if (i % CancelCheckInterval == 0 && IsCancelled(bCancelled))
+		{
+			break;
+		}
+
+		const int32 Cell = Edges[i] / 2;
+		const EDirection Direction = Edges[i] & 1 ? EDirection::North : EDirection::West;
+		const int32 X = Cell % Size.X;
+		const int32 Y = Cell / Size.X;
+		const int32 NextX = X + DirectionDX(Direction);
+		const int32 NextY = Y + DirectionDY(Direction);
 
-		const TSharedPtr<Tree> NextTree = Trees[NextY][NextX];
-		if (!CurrentTree->IsConnected(NextTree.Get()))
+		if (Sets.Union(Cell, Grid.ToIndex(NextX, NextY)))
 		{
-			CurrentTree->Connect(NextTree.Get());
-			Grid[CurrentEdge.Y][CurrentEdge.X] |= static_cast<int32>(CurrentEdge.Direction);
-			Grid[NextY][NextX] |= static_cast<int32>(OppositeDirection(CurrentEdge.Direction));
+			Grid(X, Y) |= static_cast<uint8>(Direction);
+			Grid(NextX, NextY) |= static_cast<uint8>(OppositeDirection(Direction));
 		}
 	}
 
@@ -4,36 +4,9 @@
 
 #include "CoreMinimal.h"
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
+#include "DisjointSet.h"
 
-struct FTreeEdge
-{
-	int32 X;
-	int32 Y;
-	EDirection Direction;
-
-	FTreeEdge(const int32 X, const int32 Y, const EDirection Direction): X(X), Y(Y), Direction(Direction)
-	{
-	};
-};
-
-
-class Tree
-{
-public:
-	Tree(): Parent(nullptr)
-	{
-	};
-
-	Tree* GetRoot();
-
-	bool IsConnected(Tree* const AnotherTree);
-
-	void Connect(Tree* const TreeToConnect);
-
-private:
-	Tree* Parent;
-};
 
 class Kruskal : public Algorithm
 {
@@ -41,6 +14,6 @@ public:
 	virtual ~Kruskal() override = default;
 
 private:
-	virtual TArray<TArray<uint8>> GetDirectionsGrid(const FIntVector2& Size,
-	                                                const FRandomStream& RandomStream) override;
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
 };
@@ -3,92 +3,105 @@
 
 #include "Prim.h"
 
-TArray<TArray<uint8>> Prim::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
+#include "MazeStats.h"
+
+FMazeGrid Prim::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                  const std::atomic<bool>* bCancelled) const
 {
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	TRACE_CPUPROFILER_EVENT_SCOPE(Prim::GetDirectionsGrid);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	// Frontier lives only during this call, so one instance can generate several mazes at once.
+	TArray<FIntPoint> Frontier;
 
 	const int32 RandomX = RandomStream.RandRange(0, Size.X - 1);
 	const int32 RandomY = RandomStream.RandRange(0, Size.Y - 1);
 
-	ExpandFrontierFrom(RandomX, RandomY, Grid);
+	ExpandFrontierFrom(RandomX, RandomY, Grid, Frontier);
 
-	while (!Frontier.IsEmpty())
+	for (int32 Step = 1; !Frontier.IsEmpty(); ++Step)
 	{
+		if (Step % CancelCheckInterval == 0 && IsCancelled(bCancelled))
+		{
+			break;
+		}
+
 		const int32 Index = RandomStream.RandRange(0, Frontier.Num() - 1);
-		const TPair<int32, int32> CurrentCell = Frontier[Index];
-		Frontier.RemoveAt(Index);
+		const FIntPoint CurrentCell = Frontier[Index];
+		// Order of the frontier doesn't matter, so it is O(1) removal.
+		Frontier.RemoveAtSwap(Index, EAllowShrinking::No);
 
-		TArray<TPair<int32, int32>> Neighbours = GetNeighbours(CurrentCell.Key, CurrentCell.Value, Grid);
-		const TPair<int32, int32> NextCell = Neighbours[RandomStream.RandRange(0, Neighbours.Num() - 1)];
+		FIntPoint Neighbours[4];
+		const int32 NeighboursAmount = GetNeighbours(CurrentCell.X, CurrentCell.Y, Grid, Neighbours);
+		const FIntPoint NextCell = Neighbours[RandomStream.RandRange(0, NeighboursAmount - 1)];
 
-		EDirection Direction = GetDirection(CurrentCell, NextCell);
+		const EDirection Direction = GetDirection(CurrentCell, NextCell);
 
-		// Grid[Y][X] = ...
-		Grid[CurrentCell.Value][CurrentCell.Key] |= static_cast<uint8>(Direction);
-		Grid[NextCell.Value][NextCell.Key] |= static_cast<uint8>(OppositeDirection(Direction));
+		Grid(CurrentCell.X, CurrentCell.Y) |= static_cast<uint8>(Direction);
+		Grid(NextCell.X, NextCell.Y) |= static_cast<uint8>(OppositeDirection(Direction));
 
-		ExpandFrontierFrom(CurrentCell.Key, CurrentCell.Value, Grid);
+		ExpandFrontierFrom(CurrentCell.X, CurrentCell.Y, Grid, Frontier);
 	}
 
 	return Grid;
 }
 
-void Prim::ExpandFrontierFrom(const int32 X, const int32 Y, TArray<TArray<uint8>>& Grid)
+void Prim::ExpandFrontierFrom(const int32 X, const int32 Y, FMazeGrid& Grid, TArray<FIntPoint>& Frontier)
 {
-	Grid[Y][X] |= static_cast<uint8>(ECellState::In);
-	ExpandFrontierWith(X - 1, Y, Grid);
-	ExpandFrontierWith(X + 1, Y, Grid);
-	ExpandFrontierWith(X, Y + 1, Grid);
-	ExpandFrontierWith(X, Y - 1, Grid);
+	Grid(X, Y) |= static_cast<uint8>(ECellState::In);
+	ExpandFrontierWith(X - 1, Y, Grid, Frontier);
+	ExpandFrontierWith(X + 1, Y, Grid, Frontier);
+	ExpandFrontierWith(X, Y + 1, Grid, Frontier);
+	ExpandFrontierWith(X, Y - 1, Grid, Frontier);
 }
 
-void Prim::ExpandFrontierWith(const int32 X, const int32 Y, TArray<TArray<uint8>>& Grid)
+void Prim::ExpandFrontierWith(const int32 X, const int32 Y, FMazeGrid& Grid, TArray<FIntPoint>& Frontier)
 {
-	const bool bInBounds = Y >= 0 && X >= 0 && Y < Grid.Num() && X < Grid[Y].Num();
-	if (bInBounds && Grid[Y][X] == 0)
+	if (Grid.IsValidIndex(X, Y) && Grid(X, Y) == 0)
 	{
-		Grid[Y][X] |= static_cast<uint8>(ECellState::Frontier);
+		Grid(X, Y) |= static_cast<uint8>(ECellState::Frontier);
 		Frontier.Emplace(X, Y);
 	}
 }
 
-TArray<TPair<int32, int32>> Prim::GetNeighbours(const int32 X, const int32 Y, const TArray<TArray<uint8>>& Grid)
+int32 Prim::GetNeighbours(const int32 X, const int32 Y, const FMazeGrid& Grid, FIntPoint (&OutNeighbours)[4])
 {
-	TArray<TPair<int32, int32>> Neighbours;
-	if (X > 0 && Grid[Y][X - 1] & static_cast<uint8>(ECellState::In))
+	int32 Amount = 0;
+	if (X > 0 && Grid(X - 1, Y) & static_cast<uint8>(ECellState::In))
 	{
-		Neighbours.Emplace(X - 1, Y);
+		OutNeighbours[Amount++] = FIntPoint(X - 1, Y);
 	}
-	if (X + 1 < Grid[Y].Num() && Grid[Y][X + 1] & static_cast<uint8>(ECellState::In))
+	if (X + 1 < Grid.GetWidth() && Grid(X + 1, Y) & static_cast<uint8>(ECellState::In))
 	{
-		Neighbours.Emplace(X + 1, Y);
+		OutNeighbours[Amount++] = FIntPoint(X + 1, Y);
 	}
-	if (Y > 0 && Grid[Y - 1][X] & static_cast<uint8>(ECellState::In))
+	if (Y > 0 && Grid(X, Y - 1) & static_cast<uint8>(ECellState::In))
 	{
-		Neighbours.Emplace(X, Y - 1);
+		OutNeighbours[Amount++] = FIntPoint(X, Y - 1);
 	}
-	if (Y + 1 < Grid.Num() && Grid[Y + 1][X] & static_cast<uint8>(ECellState::In))
+	if (Y + 1 < Grid.GetHeight() && Grid(X, Y + 1) & static_cast<uint8>(ECellState::In))
 	{
-		Neighbours.Emplace(X, Y + 1);
+		OutNeighbours[Amount++] = FIntPoint(X, Y + 1);
 	}
-	return Neighbours;
+	return Amount;
 }
 
-EDirection Prim::GetDirection(const TPair<int32, int32>& SourceCell, const TPair<int32, int32>& DestinationCell)
+EDirection Prim::GetDirection(const FIntPoint& SourceCell, const FIntPoint& DestinationCell)
 {
-	if (SourceCell.Key < DestinationCell.Key)
+	if (SourceCell.X < DestinationCell.X)
 	{
 		return EDirection::East;
 	}
-	if (SourceCell.Key > DestinationCell.Key)
+	if (SourceCell.X > DestinationCell.X)
 	{
 		return EDirection::West;
 	}
-	if (SourceCell.Value < DestinationCell.Value)
+	if (SourceCell.Y < DestinationCell.Y)
 	{
 		return EDirection::South;
 	}
-	if (SourceCell.Value > DestinationCell.Value)
+	if (SourceCell.Y > DestinationCell.Y)
 	{
 		return EDirection::North;
 	}
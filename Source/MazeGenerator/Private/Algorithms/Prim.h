@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
 
 
 enum class ECellState : uint8
@@ -21,16 +21,15 @@ public:
 	virtual ~Prim() override = default;
 
 private:
-	virtual TArray<TArray<uint8>> GetDirectionsGrid(const FIntVector2& Size,
-	                                                const FRandomStream& RandomStream) override;
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
 
-	void ExpandFrontierFrom(const int32 X, const int32 Y, TArray<TArray<uint8>>& Grid);
+	static void ExpandFrontierFrom(const int32 X, const int32 Y, FMazeGrid& Grid, TArray<FIntPoint>& Frontier);
 
-	void ExpandFrontierWith(const int32 X, const int32 Y, TArray<TArray<uint8>>& Grid);
+	static void ExpandFrontierWith(const int32 X, const int32 Y, FMazeGrid& Grid, TArray<FIntPoint>& Frontier);
 
-	static TArray<TPair<int32, int32>> GetNeighbours(const int32 X, const int32 Y, const TArray<TArray<uint8>>& Grid);
+	// Writes neighbours which are already in maze and returns their amount.
+	static int32 GetNeighbours(const int32 X, const int32 Y, const FMazeGrid& Grid, FIntPoint (&OutNeighbours)[4]);
 
-	static EDirection GetDirection(const TPair<int32, int32>& SourceCell, const TPair<int32, int32>& DestinationCell);
-
-	TArray<TPair<int32, int32>> Frontier;
+	static EDirection GetDirection(const FIntPoint& SourceCell, const FIntPoint& DestinationCell);
 };
@@ -2,29 +2,72 @@
 
 #include "Sidewinder.h"
 
-TArray<TArray<uint8>> Sidewinder::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream)
+#include "MazeStats.h"
+
+#include "Async/ParallelFor.h"
+
+FMazeGrid Sidewinder::GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                        const std::atomic<bool>* bCancelled) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(Sidewinder::GetDirectionsGrid);
+
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	for (int Y = 0; Y < Size.Y && !IsCancelled(bCancelled); ++Y)
+	{
+		GenerateRow(Grid, Y, RandomStream);
+	}
+
+	return Grid;
+}
+
+FMazeGrid Sidewinder::GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+                                                const std::atomic<bool>* bCancelled) const
 {
-	TArray<TArray<uint8>> Grid = CreateZeroedGrid(Size);
+	TRACE_CPUPROFILER_EVENT_SCOPE(Sidewinder::GetDirectionsGridParallel);
 
-	for (int Y = 0; Y < Size.Y; ++Y)
+	FMazeGrid Grid = CreateZeroedGrid(Size);
+
+	const uint32 BaseSeed = RandomStream.GetUnsignedInt();
+
+	// Row writes into itself and into the row above, so even and odd rows are generated in separate passes.
+	for (int32 Parity = 0; Parity < 2; ++Parity)
 	{
-		int32 RunStart = 0;
-		for (int X = 0; X < Size.X; ++X)
+		ParallelFor((Size.Y - Parity + 1) / 2, [&Grid, BaseSeed, Parity, bCancelled](const int32 Index)
 		{
-			if (Y > 0 && (X + 1 == Size.X || RandomStream.RandRange(0, 1)))
+			if (IsCancelled(bCancelled))
 			{
-				const int32 PassageCellX = RunStart + RandomStream.RandRange(0, X - RunStart);
-				Grid[Y][PassageCellX] |= static_cast<uint8>(EDirection::North);
-				Grid[Y - 1][PassageCellX] |= static_cast<uint8>(EDirection::South);
-				RunStart = X + 1;
+				return;
 			}
-			else if (X + 1 < Size.X)
-			{
-				Grid[Y][X] |= static_cast<uint8>(EDirection::East);
-				Grid[Y][X + 1] |= static_cast<uint8>(EDirection::West);
-			}
-		}
+
+			const int32 Y = Index * 2 + Parity;
+			// Each row has its own stream, so the result doesn't depend on amount of cores.
+			const FRandomStream RowRandomStream(static_cast<int32>(HashCombineFast(BaseSeed, GetTypeHash(Y))));
+			GenerateRow(Grid, Y, RowRandomStream);
+		});
 	}
 
 	return Grid;
 }
+
+void Sidewinder::GenerateRow(FMazeGrid& Grid, const int32 Y, const FRandomStream& RandomStream)
+{
+	const int32 Width = Grid.GetWidth();
+
+	int32 RunStart = 0;
+	for (int X = 0; X < Width; ++X)
+	{
+		if (Y > 0 && (X + 1 == Width || RandomStream.RandRange(0, 1)))
+		{
+			const int32 PassageCellX = RunStart + RandomStream.RandRange(0, X - RunStart);
+			Grid[Y][PassageCellX] |= static_cast<uint8>(EDirection::North);
+			Grid[Y - 1][PassageCellX] |= static_cast<uint8>(EDirection::South);
+			RunStart = X + 1;
+		}
+		else if (X + 1 < Width)
+		{
+			Grid[Y][X] |= static_cast<uint8>(EDirection::East);
+			Grid[Y][X + 1] |= static_cast<uint8>(EDirection::West);
+		}
+	}
+}
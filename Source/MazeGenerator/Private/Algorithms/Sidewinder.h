@@ -4,7 +4,7 @@
 
 #include "CoreMinimal.h"
 
-#include "Algorithm.h"
+#include "Algorithms/Algorithm.h"
 
 
 class Sidewinder : public Algorithm
@@ -13,6 +13,12 @@ public:
 	virtual ~Sidewinder() override = default;
 
 private:
-	virtual TArray<TArray<uint8>> GetDirectionsGrid(const FIntVector2& Size,
-	                                                const FRandomStream& RandomStream) override;
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
+
+	virtual FMazeGrid GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                            const std::atomic<bool>* bCancelled) const override;
+
+	// Row is linked only to the row above, so rows are independent given their random streams.
+	static void GenerateRow(FMazeGrid& Grid, const int32 Y, const FRandomStream& RandomStream);
 };
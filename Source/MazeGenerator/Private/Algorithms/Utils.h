@@ -30,3 +30,18 @@ FORCEINLINE TArray<T> ShuffleTArray(TArray<T>&& Array, const FRandomStream& Rand
 	}
 	return MoveTemp(Array);
 }
+
+// Shuffles fixed-size array in the same way as ShuffleTArray does, but without any heap allocation.
+template <typename T, int32 N>
+FORCEINLINE void ShuffleArray(T (&Array)[N], const FRandomStream& RandomStream)
+{
+	constexpr int32 LastIndex = N - 1;
+	for (int32 i = 0; i <= LastIndex; ++i)
+	{
+		const int32 RandomIndex = RandomStream.RandRange(0, LastIndex);
+		if (i != RandomIndex)
+		{
+			Swap(Array[i], Array[RandomIndex]);
+		}
+	}
+}
@@ -3,17 +3,19 @@
 
 #include "Maze.h"
 
-#include "Algorithms/Algorithm.h"
-#include "Algorithms/Backtracker.h"
-#include "Algorithms/Division.h"
 #include "Algorithms/Eller.h"
-#include "Algorithms/HaK.h"
-#include "Algorithms/Kruskal.h"
-#include "Algorithms/Prim.h"
-#include "Algorithms/Sidewinder.h"
+#include "MazeAlgorithmRegistry.h"
+#include "MazeDataAsset.h"
+#include "MazeFile.h"
+#include "MazeStats.h"
 
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/LineBatchComponent.h"
 #include "Engine/StaticMesh.h"
+#include "Tasks/Task.h"
+#include "UObject/ObjectSaveContext.h"
 
 DEFINE_LOG_CATEGORY(LogMaze);
 
@@ -57,18 +59,34 @@ FMazeCoordinates::operator TTuple<int, int>() const
 	return TPair<int32, int32>{X, Y};
 }
 
+bool FMazeBuildParameters::HasSameGeneration(const FMazeBuildParameters& Other) const
+{
+	return GenerationAlgorithm == Other.GenerationAlgorithm && Seed == Other.Seed && Size == Other.Size
+		&& bParallelGeneration == Other.bParallelGeneration && GenerationTileSize == Other.GenerationTileSize;
+}
+
+bool FMazeBuildParameters::HasSamePath(const FMazeBuildParameters& Other) const
+{
+	return bGeneratePath == Other.bGeneratePath
+		&& (!bGeneratePath || (PathStart == Other.PathStart && PathEnd == Other.PathEnd));
+}
+
+bool FMazeBuildParameters::HasSameMeshes(const FMazeBuildParameters& Other) const
+{
+	return FloorStaticMesh == Other.FloorStaticMesh && WallStaticMesh == Other.WallStaticMesh
+		&& OutlineStaticMesh == Other.OutlineStaticMesh && PathStaticMesh == Other.PathStaticMesh;
+}
+
+bool FMazeBuildParameters::HasSameLayout(const FMazeBuildParameters& Other) const
+{
+	return bMergeGeometry == Other.bMergeGeometry && ChunkSize == Other.ChunkSize
+		&& ChunkCullDistance == Other.ChunkCullDistance;
+}
+
 AMaze::AMaze()
 {
 	PrimaryActorTick.bCanEverTick = false;
 
-	GenerationAlgorithms.Add(EGenerationAlgorithm::Backtracker, TSharedPtr<Algorithm>(new Backtracker));
-	GenerationAlgorithms.Add(EGenerationAlgorithm::Division, TSharedPtr<Algorithm>(new Division));
-	GenerationAlgorithms.Add(EGenerationAlgorithm::HaK, TSharedPtr<Algorithm>(new HaK));
-	GenerationAlgorithms.Add(EGenerationAlgorithm::Sidewinder, TSharedPtr<Algorithm>(new Sidewinder));
-	GenerationAlgorithms.Add(EGenerationAlgorithm::Kruskal, TSharedPtr<Algorithm>(new Kruskal));
-	GenerationAlgorithms.Add(EGenerationAlgorithm::Eller, TSharedPtr<Algorithm>(new Eller));
-	GenerationAlgorithms.Add(EGenerationAlgorithm::Prim, TSharedPtr<Algorithm>(new Prim));
-
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 
 	FloorCells = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("FloorCells"));
@@ -98,12 +116,85 @@ AMaze::AMaze()
 
 void AMaze::UpdateMaze()
 {
-	ClearMaze();
+	SCOPE_CYCLE_COUNTER(STAT_MazeUpdate);
+
+	CancelMazeGeneration();
+
+	if (!PrepareCells() || LoadBakedMaze())
+	{
+		return;
+	}
+
+	BuildMaze(GenerateMaze(MakeGenerationRequest()));
+}
+
+void AMaze::UpdateMazeAsync()
+{
+	CancelMazeGeneration();
+
+	if (!PrepareCells() || LoadBakedMaze())
+	{
+		return;
+	}
 
+	const TSharedRef<std::atomic<bool>> bCancelled = MakeShared<std::atomic<bool>>(false);
+	PendingGenerationCancelled = bCancelled;
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION,
+	                  [WeakThis = TWeakObjectPtr<AMaze>(this), Request = MakeGenerationRequest(), bCancelled]
+	                  {
+		                  FMazeGenerationResult Result = GenerateMaze(Request, &bCancelled.Get());
+		                  if (*bCancelled)
+		                  {
+			                  return;
+		                  }
+
+		                  // Components can only be touched on the game thread.
+		                  AsyncTask(ENamedThreads::GameThread,
+		                            [WeakThis, bCancelled, Result = MoveTemp(Result)]() mutable
+		                            {
+			                            AMaze* Maze = WeakThis.Get();
+			                            if (!Maze || *bCancelled)
+			                            {
+				                            return;
+			                            }
+			                            Maze->PendingGenerationCancelled.Reset();
+			                            Maze->BuildMaze(MoveTemp(Result));
+		                            });
+	                  });
+}
+
+void AMaze::CancelMazeGeneration()
+{
+	if (PendingGenerationCancelled)
+	{
+		*PendingGenerationCancelled = true;
+		PendingGenerationCancelled.Reset();
+	}
+}
+
+bool AMaze::IsGeneratingMaze() const
+{
+	return PendingGenerationCancelled.IsValid();
+}
+
+bool AMaze::PrepareCells()
+{
 	if (!(FloorStaticMesh && WallStaticMesh))
 	{
+		ClearMaze();
+		BuiltParameters.Reset();
 		UE_LOG(LogMaze, Warning, TEXT("To create maze specify FloorStaticMesh and WallStaticMesh."));
-		return;
+		return false;
+	}
+
+	if (!FMazeAlgorithmRegistry::Get().Contains(GetGenerationAlgorithmName()))
+	{
+		ClearMaze();
+		BuiltParameters.Reset();
+		UE_LOG(LogMaze, Warning, TEXT("Generation algorithm %s is not registered."),
+		       *GetGenerationAlgorithmName().ToString());
+		return false;
 	}
 
 	FloorCells->SetStaticMesh(FloorStaticMesh);
@@ -116,49 +207,806 @@ void AMaze::UpdateMaze()
 	{
 		PathFloorCells->SetStaticMesh(PathStaticMesh);
 	}
+	for (const FMazeCellsChunk& Chunk : CellChunks)
+	{
+		if (IsValid(Chunk.FloorCells) && IsValid(Chunk.WallCells) && IsValid(Chunk.PathFloorCells))
+		{
+			Chunk.FloorCells->SetStaticMesh(FloorStaticMesh);
+			Chunk.WallCells->SetStaticMesh(WallStaticMesh);
+			if (PathStaticMesh)
+			{
+				Chunk.PathFloorCells->SetStaticMesh(PathStaticMesh);
+			}
+		}
+	}
 
 	MazeCellSize = GetMaxCellSize();
+	return true;
+}
+
+FMazeGenerationRequest AMaze::MakeGenerationRequest()
+{
+	FMazeGenerationRequest Request;
+	Request.GenerationAlgorithm = FMazeAlgorithmRegistry::Get().Find(GetGenerationAlgorithmName());
+	Request.Size = MazeSize;
+	Request.Seed = Seed;
+	Request.bParallel = bParallelGeneration;
+	// Tile size is specified in maze cells, which are twice as many as directions grid cells.
+	Request.TileSize = GenerationTileSize / 2;
+	Request.bGeneratePath = bGeneratePath;
+	if (bGeneratePath)
+	{
+		PathStart.ClampByMazeSize(MazeSize);
+		PathEnd.ClampByMazeSize(MazeSize);
+	}
+	Request.PathStart = PathStart;
+	Request.PathEnd = PathEnd;
+	Request.PathfindingMode = PathfindingMode;
+	Request.bPrecomputePathQueries = bPrecomputePathQueries;
+	return Request;
+}
+
+FMazeGenerationResult AMaze::GenerateMaze(const FMazeGenerationRequest& Request, const std::atomic<bool>* bCancelled)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMaze::GenerateMaze);
+
+	FMazeGenerationResult Result;
+	Result.bGeneratePath = Request.bGeneratePath;
+
+	FGenerationOptions GenerationOptions;
+	GenerationOptions.bParallel = Request.bParallel;
+	GenerationOptions.TileSize = Request.TileSize;
+	GenerationOptions.bCancelled = bCancelled;
+	Result.Passages = Request.GenerationAlgorithm->GetPassages(Request.Size, Request.Seed, GenerationOptions);
+
+	if (Request.bGeneratePath && !(bCancelled && *bCancelled))
+	{
+		FMazePathfinder Pathfinder;
+		FindPath(Pathfinder, Result.Passages, Request.PathStart, Request.PathEnd, Request.PathfindingMode,
+		         Result.PathCells, Result.PathLength);
+	}
+
+	if (Request.bPrecomputePathQueries && !(bCancelled && *bCancelled))
+	{
+		Result.PathTree = FMazePathTree(Result.Passages);
+	}
+
+	return Result;
+}
+
+void AMaze::BuildMaze(FMazeGenerationResult&& Result)
+{
+	MazePassages = MoveTemp(Result.Passages);
+	MazePathCells = MoveTemp(Result.PathCells);
+	PathTree = MoveTemp(Result.PathTree);
+	FlowField.Empty();
+	if (Result.bGeneratePath)
+	{
+		PathLength = Result.PathLength;
+	}
+
+	CreateInstances();
+
+	EnableCollision(bUseCollision);
+
+	UpdateStats();
+
+	BuiltParameters = GetBuildParameters();
+
+#if WITH_EDITOR
+	ClearEditorPreview();
+#endif
+
+	OnMazeGenerated.Broadcast(this);
+}
+
+void AMaze::UpdateChangedMaze(const bool bAsync)
+{
+	const FMazeBuildParameters Parameters = GetBuildParameters();
+	if (!BuiltParameters || IsGeneratingMaze() || MazePassages.IsEmpty()
+		|| !BuiltParameters->HasSameGeneration(Parameters))
+	{
+		if (bAsync)
+		{
+			UpdateMazeAsync();
+		}
+		else
+		{
+			UpdateMaze();
+		}
+		return;
+	}
+
+	const bool bSamePath = BuiltParameters->HasSamePath(Parameters);
+	const bool bSameMeshes = BuiltParameters->HasSameMeshes(Parameters);
+	const bool bSameLayout = BuiltParameters->HasSameLayout(Parameters);
+	if (bSamePath && bSameMeshes && bSameLayout)
+	{
+		if (BuiltParameters->bUseCollision != bUseCollision)
+		{
+			EnableCollision(bUseCollision);
+			BuiltParameters->bUseCollision = bUseCollision;
+		}
+		return;
+	}
+
+	bool bRelayout = !bSameLayout;
+	if (!bSameMeshes)
+	{
+		const FVector2D PreviousCellSize = MazeCellSize;
+		if (!PrepareCells())
+		{
+			return;
+		}
+		// Instances are kept while meshes of the same size are swapped.
+		// Merged instances are stretched by mesh bounds, and path or outline may appear or disappear.
+		bRelayout |= MazeCellSize != PreviousCellSize || bMergeGeometry
+			|| !BuiltParameters->OutlineStaticMesh != !OutlineStaticMesh
+			|| !BuiltParameters->PathStaticMesh != !PathStaticMesh;
+	}
+
+	if (!bSamePath)
+	{
+		UpdatePath();
+		bRelayout |= PathStaticMesh != nullptr;
+	}
+
+	if (bRelayout)
+	{
+		CreateInstances();
+		EnableCollision(bUseCollision);
+		UpdateStats();
+	}
+	else if (BuiltParameters->bUseCollision != bUseCollision)
+	{
+		EnableCollision(bUseCollision);
+	}
+
+	BuiltParameters = GetBuildParameters();
+
+	if (bRelayout || !bSamePath)
+	{
+		OnMazeGenerated.Broadcast(this);
+	}
+}
+
+void AMaze::UpdatePath()
+{
+	MazePathCells.Empty();
+	if (!bGeneratePath)
+	{
+		return;
+	}
+
+	PathStart.ClampByMazeSize(MazeSize);
+	PathEnd.ClampByMazeSize(MazeSize);
+	if (!FindPath(Pathfinder, MazePassages, PathStart, PathEnd, PathfindingMode, MazePathCells, PathLength))
+	{
+		MazePathCells.Empty();
+	}
+}
+
+FMazeBuildParameters AMaze::GetBuildParameters() const
+{
+	FMazeBuildParameters Parameters;
+	Parameters.GenerationAlgorithm = GetGenerationAlgorithmName();
+	Parameters.Seed = Seed;
+	Parameters.Size = MazeSize;
+	Parameters.bParallelGeneration = bParallelGeneration;
+	Parameters.GenerationTileSize = GenerationTileSize;
+	Parameters.bGeneratePath = bGeneratePath;
+	Parameters.PathStart = FIntPoint(PathStart.X, PathStart.Y);
+	Parameters.PathEnd = FIntPoint(PathEnd.X, PathEnd.Y);
+	Parameters.FloorStaticMesh = FloorStaticMesh;
+	Parameters.WallStaticMesh = WallStaticMesh;
+	Parameters.OutlineStaticMesh = OutlineStaticMesh;
+	Parameters.PathStaticMesh = PathStaticMesh;
+	Parameters.bMergeGeometry = bMergeGeometry;
+	Parameters.ChunkSize = ChunkSize;
+	Parameters.ChunkCullDistance = ChunkCullDistance;
+	Parameters.bUseCollision = bUseCollision;
+	return Parameters;
+}
+
+bool AMaze::LoadBakedMaze()
+{
+	if (!bBakeMazeData || !BakedMazeData || BakedMazeData->InputsHash != GetBakeInputsHash())
+	{
+		return false;
+	}
+
+	int32 ChunksAmount = 1;
+	if (ChunkSize > 0)
+	{
+		ChunksAmount = FMath::DivideAndRoundUp(MazeSize.X, ChunkSize) * FMath::DivideAndRoundUp(MazeSize.Y, ChunkSize);
+	}
+	if (BakedMazeData->Chunks.Num() != ChunksAmount)
+	{
+		return false;
+	}
+
+	// Baked data is read from disk, so passages are built only if their words fit the baked size.
+	const FIntPoint BakedSize = BakedMazeData->MazeSize;
+	if (BakedSize.X <= 0 || BakedSize.Y <= 0 || BakedMazeData->PassageWords.Num()
+		!= FMath::DivideAndRoundUp((BakedSize.X + 1) / 2 * ((BakedSize.Y + 1) / 2) * 2, 64))
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MazeLoadBaked);
+
+	MazePassages = BakedMazeData->GetPassages();
+	MazePathCells = BakedMazeData->GetPathCells();
+	PathTree = bPrecomputePathQueries ? FMazePathTree(MazePassages) : FMazePathTree();
+	FlowField.Empty();
+	if (bGeneratePath)
+	{
+		PathLength = BakedMazeData->PathLength;
+	}
+
+	UpdateChunks();
+
+	const TArray<UHierarchicalInstancedStaticMeshComponent*> Components = GetCellComponents();
+	for (UHierarchicalInstancedStaticMeshComponent* Component : Components)
+	{
+		Component->bAutoRebuildTreeOnInstanceChanges = false;
+		Component->ClearInstances();
+	}
+
+	OutlineWallCells->AddInstances(BakedMazeData->OutlineTransforms, false);
+	for (int32 Index = 0; Index < CellChunks.Num(); ++Index)
+	{
+		FMazeCellsChunk& Chunk = CellChunks[Index];
+		const FMazeBakedChunk& BakedChunk = BakedMazeData->Chunks[Index];
+		Chunk.FloorCells->AddInstances(BakedChunk.FloorTransforms, false);
+		Chunk.WallCells->AddInstances(BakedChunk.WallTransforms, false);
+		Chunk.PathFloorCells->AddInstances(BakedChunk.PathTransforms, false);
+		// Baked instances are not tracked per cell, so the next generation places cells from scratch.
+		Chunk.FloorSlots.Empty();
+		Chunk.WallSlots.Empty();
+		Chunk.PathSlots.Empty();
+	}
+	BuiltCellSize = FVector2D::ZeroVector;
+
+	for (UHierarchicalInstancedStaticMeshComponent* Component : Components)
+	{
+		Component->bAutoRebuildTreeOnInstanceChanges = true;
+		Component->BuildTreeIfOutdated(true, false);
+		Component->MarkRenderStateDirty();
+	}
+
+	EnableCollision(bUseCollision);
+
+	UpdateStats();
+
+	BuiltParameters = GetBuildParameters();
+
+	OnMazeGenerated.Broadcast(this);
+	return true;
+}
+
+uint32 AMaze::GetBakeInputsHash() const
+{
+	uint32 Hash = GetTypeHash(GenerationAlgorithm);
+	if (!CustomGenerationAlgorithm.IsNone())
+	{
+		// Hash of FName differs between sessions.
+		Hash = HashCombine(Hash, GetTypeHash(CustomGenerationAlgorithm.ToString()));
+	}
+	Hash = HashCombine(Hash, GetTypeHash(Seed));
+	Hash = HashCombine(Hash, GetTypeHash(FIntPoint(MazeSize.X, MazeSize.Y)));
+	Hash = HashCombine(Hash, GetTypeHash(bParallelGeneration));
+	Hash = HashCombine(Hash, GetTypeHash(GenerationTileSize));
+	Hash = HashCombine(Hash, GetTypeHash(bGeneratePath));
+	if (bGeneratePath)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(FIntPoint(PathStart.X, PathStart.Y)));
+		Hash = HashCombine(Hash, GetTypeHash(FIntPoint(PathEnd.X, PathEnd.Y)));
+	}
+	// Paths instead of pointers, so the hash is the same after reload.
+	for (const UStaticMesh* Mesh : {FloorStaticMesh, WallStaticMesh, OutlineStaticMesh, PathStaticMesh})
+	{
+		Hash = HashCombine(Hash, GetTypeHash(GetPathNameSafe(Mesh)));
+	}
+	Hash = HashCombine(Hash, GetTypeHash(MazeCellSize));
+	Hash = HashCombine(Hash, GetTypeHash(bMergeGeometry));
+	Hash = HashCombine(Hash, GetTypeHash(ChunkSize));
+	// 0 is reserved for data that has never been baked.
+	return Hash ? Hash : 1;
+}
+
+void AMaze::CreateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeCreateInstances);
+
+	OutlineWallCells->ClearInstances();
+
+	UpdateChunks();
+
+	if (bMergeGeometry || BuiltCellSize != MazeCellSize)
+	{
+		for (FMazeCellsChunk& Chunk : CellChunks)
+		{
+			Chunk.FloorCells->ClearInstances();
+			Chunk.WallCells->ClearInstances();
+			Chunk.PathFloorCells->ClearInstances();
+			Chunk.FloorSlots.Empty();
+			Chunk.WallSlots.Empty();
+			Chunk.PathSlots.Empty();
+		}
+	}
+
+	const TArray<UHierarchicalInstancedStaticMeshComponent*> Components = GetCellComponents();
+	// Tree of every component is rebuilt once, after all instances are added.
+	for (UHierarchicalInstancedStaticMeshComponent* Component : Components)
+	{
+		Component->bAutoRebuildTreeOnInstanceChanges = false;
+	}
 
 	if (OutlineStaticMesh)
 	{
-		CreateMazeOutline();
+		CreateMazeOutline();
+	}
+
+	if (bMergeGeometry)
+	{
+		for (FMazeCellsChunk& Chunk : CellChunks)
+		{
+			CreateMergedMazeCells(Chunk);
+		}
+		BuiltCellSize = FVector2D::ZeroVector;
+	}
+	else
+	{
+		CreateMazeCells();
+		BuiltCellSize = MazeCellSize;
+	}
+
+	// Untouched components keep their trees and render state.
+	for (UHierarchicalInstancedStaticMeshComponent* Component : Components)
+	{
+		Component->bAutoRebuildTreeOnInstanceChanges = true;
+		if (Component->BuildTreeIfOutdated(true, false))
+		{
+			Component->MarkRenderStateDirty();
+		}
+	}
+}
+
+void AMaze::UpdateChunks()
+{
+	const FIntVector2 Size = MazePassages.GetMazeSize();
+
+	TArray<FIntVector2> Origins;
+	TArray<FIntVector2> Sizes;
+	if (ChunkSize > 0)
+	{
+		for (int32 Y = 0; Y < Size.Y; Y += ChunkSize)
+		{
+			for (int32 X = 0; X < Size.X; X += ChunkSize)
+			{
+				Origins.Emplace(X, Y);
+				Sizes.Emplace(FMath::Min(ChunkSize, Size.X - X), FMath::Min(ChunkSize, Size.Y - Y));
+			}
+		}
+	}
+	else
+	{
+		Origins.Emplace(0, 0);
+		Sizes.Add(Size);
+	}
+
+	const bool bChunked = ChunkSize > 0;
+	bool bSameLayout = CellChunks.Num() == Origins.Num();
+	for (int32 Index = 0; bSameLayout && Index < CellChunks.Num(); ++Index)
+	{
+		const FMazeCellsChunk& Chunk = CellChunks[Index];
+		bSameLayout = IsValid(Chunk.FloorCells) && IsValid(Chunk.WallCells) && IsValid(Chunk.PathFloorCells)
+			&& (Chunk.FloorCells != FloorCells) == bChunked
+			&& (bChunked ? Chunk.Origin == Origins[Index] && Chunk.Size == Sizes[Index] : true);
+	}
+
+	if (bSameLayout)
+	{
+		// Single chunk made of default components just follows maze size, its instances are kept.
+		if (!bChunked)
+		{
+			CellChunks[0].Size = Size;
+		}
+		for (const FMazeCellsChunk& Chunk : CellChunks)
+		{
+			if (Chunk.FloorCells != FloorCells)
+			{
+				Chunk.FloorCells->SetCullDistances(0, ChunkCullDistance);
+				Chunk.WallCells->SetCullDistances(0, ChunkCullDistance);
+				Chunk.PathFloorCells->SetCullDistances(0, ChunkCullDistance);
+			}
+		}
+		return;
+	}
+
+	DestroyChunks();
+
+	if (!bChunked)
+	{
+		FMazeCellsChunk& Chunk = CellChunks.AddDefaulted_GetRef();
+		Chunk.FloorCells = FloorCells;
+		Chunk.WallCells = WallCells;
+		Chunk.PathFloorCells = PathFloorCells;
+		Chunk.Size = Size;
+		return;
+	}
+
+	// Default components stay empty while maze is split into chunks.
+	FloorCells->ClearInstances();
+	WallCells->ClearInstances();
+	PathFloorCells->ClearInstances();
+
+	CellChunks.Reserve(Origins.Num());
+	for (int32 Index = 0; Index < Origins.Num(); ++Index)
+	{
+		FMazeCellsChunk& Chunk = CellChunks.AddDefaulted_GetRef();
+		Chunk.FloorCells = CreateChunkComponent(FloorStaticMesh);
+		Chunk.WallCells = CreateChunkComponent(WallStaticMesh);
+		Chunk.PathFloorCells = CreateChunkComponent(PathStaticMesh);
+		Chunk.Origin = Origins[Index];
+		Chunk.Size = Sizes[Index];
+	}
+}
+
+UHierarchicalInstancedStaticMeshComponent* AMaze::CreateChunkComponent(UStaticMesh* Mesh)
+{
+	UHierarchicalInstancedStaticMeshComponent* Component =
+		NewObject<UHierarchicalInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+	Component->SetupAttachment(GetRootComponent());
+	if (Mesh)
+	{
+		Component->SetStaticMesh(Mesh);
+	}
+	Component->SetCullDistances(0, ChunkCullDistance);
+	Component->RegisterComponent();
+	return Component;
+}
+
+void AMaze::DestroyChunks()
+{
+	for (const FMazeCellsChunk& Chunk : CellChunks)
+	{
+		for (UHierarchicalInstancedStaticMeshComponent* Component :
+		     {Chunk.FloorCells, Chunk.WallCells, Chunk.PathFloorCells})
+		{
+			if (IsValid(Component) && Component != FloorCells && Component != WallCells && Component != PathFloorCells)
+			{
+				Component->DestroyComponent();
+			}
+		}
+	}
+	CellChunks.Empty();
+}
+
+TArray<UHierarchicalInstancedStaticMeshComponent*> AMaze::GetCellComponents() const
+{
+	TArray<UHierarchicalInstancedStaticMeshComponent*> Components{OutlineWallCells};
+	for (const FMazeCellsChunk& Chunk : CellChunks)
+	{
+		Components.Append({Chunk.FloorCells, Chunk.WallCells, Chunk.PathFloorCells});
+	}
+	return Components;
+}
+
+FMazeChunkCells AMaze::GetChunkCells(const FMazeCellsChunk& Chunk) const
+{
+	const bool bDrawPath = ShouldDrawPath();
+	const int32 MazeWidth = MazePassages.GetMazeSize().X;
+
+	FMazeChunkCells Cells;
+	Cells.Floor.Init(false, Chunk.Size.X * Chunk.Size.Y);
+	Cells.Wall.Init(false, Chunk.Size.X * Chunk.Size.Y);
+	Cells.Path.Init(false, Chunk.Size.X * Chunk.Size.Y);
+	for (int32 Y = 0; Y < Chunk.Size.Y; ++Y)
+	{
+		for (int32 X = 0; X < Chunk.Size.X; ++X)
+		{
+			const int32 Index = Y * Chunk.Size.X + X;
+			const int32 MazeX = Chunk.Origin.X + X;
+			const int32 MazeY = Chunk.Origin.Y + Y;
+			if (bDrawPath && MazePathCells[MazeY * MazeWidth + MazeX])
+			{
+				Cells.Path[Index] = true;
+			}
+			else if (MazePassages.IsFloor(MazeX, MazeY))
+			{
+				Cells.Floor[Index] = true;
+			}
+			else
+			{
+				Cells.Wall[Index] = true;
+			}
+		}
+	}
+	return Cells;
+}
+
+void AMaze::CreateMazeCells()
+{
+	TArray<FMazeChunkCells> ChunksCells;
+	ChunksCells.SetNum(CellChunks.Num());
+	ParallelFor(CellChunks.Num(), [this, &ChunksCells](const int32 Index)
+	{
+		ChunksCells[Index] = GetChunkCells(CellChunks[Index]);
+	});
+
+	for (int32 Index = 0; Index < CellChunks.Num(); ++Index)
+	{
+		FMazeCellsChunk& Chunk = CellChunks[Index];
+		UpdateCellInstances(Chunk.FloorCells, Chunk, ChunksCells[Index].Floor, Chunk.FloorSlots);
+		UpdateCellInstances(Chunk.WallCells, Chunk, ChunksCells[Index].Wall, Chunk.WallSlots);
+		UpdateCellInstances(Chunk.PathFloorCells, Chunk, ChunksCells[Index].Path, Chunk.PathSlots);
+	}
+}
+
+void AMaze::UpdateCellInstances(UHierarchicalInstancedStaticMeshComponent* Component, const FMazeCellsChunk& Chunk,
+                                const TBitArray<>& Cells, TArray<uint32>& Slots) const
+{
+	const FIntVector2 Origin = Chunk.Origin;
+	const FIntVector2 Size = Chunk.Size;
+
+	auto GetTransform = [this](const uint32 Slot)
+	{
+		return FTransform(FVector{MazeCellSize.X * (Slot & 0xFFFF), MazeCellSize.Y * (Slot >> 16), 0.f});
+	};
+	auto GetSlot = [&Origin, &Size](const int32 Index)
+	{
+		return static_cast<uint32>(Origin.Y + Index / Size.X) << 16 | static_cast<uint32>(Origin.X + Index % Size.X);
+	};
+
+	if (Slots.Num() != Component->GetInstanceCount())
+	{
+		Component->ClearInstances();
+		Slots.Empty();
+	}
+
+	// Cells left after the scan have no instance yet.
+	TBitArray<> AddedCells = Cells;
+	TArray<int32> FreeSlots;
+	FreeSlots.Reserve(Slots.Num());
+	for (int32 Slot = 0; Slot < Slots.Num(); ++Slot)
+	{
+		const int32 X = (Slots[Slot] & 0xFFFF) - Origin.X;
+		const int32 Y = (Slots[Slot] >> 16) - Origin.Y;
+		if (X >= 0 && Y >= 0 && X < Size.X && Y < Size.Y && AddedCells[Y * Size.X + X])
+		{
+			AddedCells[Y * Size.X + X] = false;
+		}
+		else
+		{
+			FreeSlots.Add(Slot);
+		}
+	}
+
+	// Moved instances are submitted at once instead of a transform update per instance.
+	TArray<int32> MovedSlots;
+	TArray<FTransform> MovedTransforms;
+	MovedSlots.Reserve(FreeSlots.Num());
+	MovedTransforms.Reserve(FreeSlots.Num());
+	auto MoveInstance = [&](const int32 Slot)
+	{
+		MovedSlots.Add(Slot);
+		MovedTransforms.Add(GetTransform(Slots[Slot]));
+	};
+
+	const int32 AddedAmount = AddedCells.CountSetBits();
+	TConstSetBitIterator<> It(AddedCells);
+	int32 FreeIndex = 0;
+	for (; It && FreeIndex < FreeSlots.Num(); ++It, ++FreeIndex)
+	{
+		const int32 Slot = FreeSlots[FreeIndex];
+		Slots[Slot] = GetSlot(It.GetIndex());
+		MoveInstance(Slot);
+	}
+
+	if (It)
+	{
+		// All free slots are taken at this point, the rest of added cells get new instances.
+		TArray<FTransform> Transforms;
+		Transforms.Reserve(AddedAmount - FreeIndex);
+		Slots.Reserve(Slots.Num() + AddedAmount - FreeIndex);
+		for (; It; ++It)
+		{
+			Slots.Add(GetSlot(It.GetIndex()));
+			Transforms.Add(GetTransform(Slots.Last()));
+		}
+		Component->AddInstances(Transforms, false);
+	}
+	else if (FreeIndex < FreeSlots.Num())
+	{
+		// Instances kept in the tail are moved into free slots, so only the tail has to be removed.
+		const int32 NewNum = Slots.Num() - (FreeSlots.Num() - FreeIndex);
+		TBitArray<> FreeMarks(false, Slots.Num());
+		for (int32 Index = FreeIndex; Index < FreeSlots.Num(); ++Index)
+		{
+			FreeMarks[FreeSlots[Index]] = true;
+		}
+
+		int32 Destination = FreeIndex;
+		for (int32 Source = NewNum; Source < Slots.Num(); ++Source)
+		{
+			if (FreeMarks[Source])
+			{
+				continue;
+			}
+			const int32 Slot = FreeSlots[Destination++];
+			Slots[Slot] = Slots[Source];
+			MoveInstance(Slot);
+		}
+
+		TArray<int32> RemovedSlots;
+		RemovedSlots.Reserve(Slots.Num() - NewNum);
+		for (int32 Slot = Slots.Num() - 1; Slot >= NewNum; --Slot)
+		{
+			RemovedSlots.Add(Slot);
+		}
+		Component->RemoveInstances(RemovedSlots);
+		Slots.SetNum(NewNum, EAllowShrinking::No);
+	}
+
+	// Only the tail is removed, so moved slots keep their indices.
+	if (!MovedSlots.IsEmpty())
+	{
+		// Instances are teleported, so previous transforms are the same as the new ones.
+		Component->UpdateInstances(MovedSlots, MovedTransforms, MovedTransforms, 0, TArray<float>());
+	}
+}
+
+void AMaze::CreateMergedMazeCells(const FMazeCellsChunk& Chunk) const
+{
+	const int32 MazeWidth = MazePassages.GetMazeSize().X;
+	const int32 MinX = Chunk.Origin.X;
+	const int32 MinY = Chunk.Origin.Y;
+	const int32 MaxX = Chunk.Origin.X + Chunk.Size.X;
+	const int32 MaxY = Chunk.Origin.Y + Chunk.Size.Y;
+	const bool bDrawPath = ShouldDrawPath();
+
+	// A row has at most one run per cell pair, and vertical wall runs start at walls left out of horizontal ones.
+	const int32 MaxRunsAmount = Chunk.Size.Y * ((Chunk.Size.X + 1) / 2);
+	TArray<FTransform> PathTransforms;
+	TArray<FTransform> FloorTransforms;
+	TArray<FTransform> WallTransforms;
+	FloorTransforms.Reserve(bDrawPath ? MaxRunsAmount : 1);
+	WallTransforms.Reserve(MaxRunsAmount);
+
+	if (bDrawPath)
+	{
+		PathTransforms.Reserve(FMath::Min(PathLength, Chunk.Size.X * Chunk.Size.Y));
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			for (int32 X = MinX; X < MaxX; ++X)
+			{
+				if (MazePathCells[Y * MazeWidth + X])
+				{
+					PathTransforms.Emplace(FVector{MazeCellSize.X * X, MazeCellSize.Y * Y, 0.f});
+				}
+			}
+		}
+
+		// Path floor would overlap a single floor plane, so floor is merged into horizontal runs around the path.
+		for (int32 Y = MinY; Y < MaxY; ++Y)
+		{
+			for (int32 X = MinX; X < MaxX;)
+			{
+				int32 RunEnd = X;
+				while (RunEnd < MaxX && MazePassages.IsFloor(RunEnd, Y) && !MazePathCells[Y * MazeWidth + RunEnd])
+				{
+					++RunEnd;
+				}
+				if (RunEnd > X)
+				{
+					FloorTransforms.Add(GetMergedTransform(FloorStaticMesh, X, Y, FIntVector2(RunEnd - X, 1)));
+					X = RunEnd;
+				}
+				else
+				{
+					++X;
+				}
+			}
+		}
+	}
+	else
+	{
+		FloorTransforms.Add(GetMergedTransform(FloorStaticMesh, MinX, MinY, Chunk.Size));
 	}
-	MazeGrid = GenerationAlgorithms[GenerationAlgorithm]->GetGrid(MazeSize, Seed);
 
-	if (bGeneratePath)
+	// Horizontal runs first, then single walls left are merged into vertical runs.
+	TBitArray<> MergedWalls(false, Chunk.Size.X * Chunk.Size.Y);
+	for (int32 Y = MinY; Y < MaxY; ++Y)
 	{
-		PathStart.ClampByMazeSize(MazeSize);
-		PathEnd.ClampByMazeSize(MazeSize);
-		MazePathGrid = GetMazePath(PathStart, PathEnd, PathLength);
+		for (int32 X = MinX; X < MaxX;)
+		{
+			int32 RunEnd = X;
+			while (RunEnd < MaxX && !MazePassages.IsFloor(RunEnd, Y))
+			{
+				++RunEnd;
+			}
+			if (RunEnd - X > 1)
+			{
+				WallTransforms.Add(GetMergedTransform(WallStaticMesh, X, Y, FIntVector2(RunEnd - X, 1)));
+				MergedWalls.SetRange((Y - MinY) * Chunk.Size.X + X - MinX, RunEnd - X, true);
+			}
+			X = FMath::Max(RunEnd, X + 1);
+		}
 	}
-
-	for (int32 Y = 0; Y < MazeSize.Y; ++Y)
+	for (int32 X = MinX; X < MaxX; ++X)
 	{
-		for (int32 X = 0; X < MazeSize.X; ++X)
+		for (int32 Y = MinY; Y < MaxY;)
 		{
-			if (bGeneratePath && PathStaticMesh && MazePathGrid.Num() > 0 && MazePathGrid[Y][X])
+			int32 RunEnd = Y;
+			while (RunEnd < MaxY && !MazePassages.IsFloor(X, RunEnd)
+				&& !MergedWalls[(RunEnd - MinY) * Chunk.Size.X + X - MinX])
 			{
-				const FVector Location(MazeCellSize.X * X, MazeCellSize.Y * Y, 0.f);
-				PathFloorCells->AddInstance(FTransform(Location));
+				++RunEnd;
 			}
-			else if (MazeGrid[Y][X])
+			if (RunEnd > Y)
 			{
-				const FVector Location{MazeCellSize.X * X, MazeCellSize.Y * Y, 0.f};
-				FloorCells->AddInstance(FTransform(Location));
+				WallTransforms.Add(GetMergedTransform(WallStaticMesh, X, Y, FIntVector2(1, RunEnd - Y)));
+				Y = RunEnd;
 			}
 			else
 			{
-				const FVector Location{MazeCellSize.X * X, MazeCellSize.Y * Y, 0.f};
-				WallCells->AddInstance(FTransform(Location));
+				++Y;
 			}
 		}
 	}
 
-	EnableCollision(bUseCollision);
+	Chunk.PathFloorCells->AddInstances(PathTransforms, false);
+	Chunk.FloorCells->AddInstances(FloorTransforms, false);
+	Chunk.WallCells->AddInstances(WallTransforms, false);
+}
+
+FTransform AMaze::GetMergedTransform(const UStaticMesh* Mesh, const int32 X, const int32 Y,
+                                     const FIntVector2& RunSize) const
+{
+	const FBox Bounds = Mesh->GetBoundingBox();
+	const FVector MeshSize = Bounds.GetSize();
+
+	// Mesh is stretched from the beginning of its first copy to the end of its last copy.
+	const FVector Scale{
+		MeshSize.X > 0.f ? ((RunSize.X - 1) * MazeCellSize.X + MeshSize.X) / MeshSize.X : 1.f,
+		MeshSize.Y > 0.f ? ((RunSize.Y - 1) * MazeCellSize.Y + MeshSize.Y) / MeshSize.Y : 1.f,
+		1.f
+	};
+	const FVector Location{
+		MazeCellSize.X * X + Bounds.Min.X * (1.f - Scale.X),
+		MazeCellSize.Y * Y + Bounds.Min.Y * (1.f - Scale.Y),
+		0.f
+	};
+	return FTransform(FQuat::Identity, Location, Scale);
+}
+
+bool AMaze::ShouldDrawPath() const
+{
+	const FIntVector2 Size = MazePassages.GetMazeSize();
+	return bGeneratePath && PathStaticMesh && MazePathCells.Num() == Size.X * Size.Y;
 }
 
 void AMaze::CreateMazeOutline() const
 {
+	const FIntVector2 MazeSize = MazePassages.GetMazeSize();
+
+	if (bMergeGeometry)
+	{
+		const TArray<FTransform> Transforms{
+			GetMergedTransform(OutlineStaticMesh, -1, -1, FIntVector2(MazeSize.X + 2, 1)),
+			GetMergedTransform(OutlineStaticMesh, -1, MazeSize.Y, FIntVector2(MazeSize.X + 2, 1)),
+			GetMergedTransform(OutlineStaticMesh, -1, 0, FIntVector2(1, MazeSize.Y)),
+			GetMergedTransform(OutlineStaticMesh, MazeSize.X, 0, FIntVector2(1, MazeSize.Y))
+		};
+		OutlineWallCells->AddInstances(Transforms, false);
+		return;
+	}
+
+	TArray<FTransform> Transforms;
+	Transforms.Reserve((MazeSize.X + 2) * 2 + MazeSize.Y * 2);
+
 	FVector Location1{0.f};
 	FVector Location2{0.f};
 
@@ -167,8 +1015,8 @@ void AMaze::CreateMazeOutline() const
 	for (int32 X = -1; X < MazeSize.X + 1; ++X)
 	{
 		Location1.X = Location2.X = X * MazeCellSize.X;
-		OutlineWallCells->AddInstance(FTransform{Location1});
-		OutlineWallCells->AddInstance(FTransform{Location2});
+		Transforms.Emplace(Location1);
+		Transforms.Emplace(Location2);
 	}
 
 	Location1.X = -MazeCellSize.X;
@@ -176,135 +1024,292 @@ void AMaze::CreateMazeOutline() const
 	for (int32 Y = 0; Y < MazeSize.Y; ++Y)
 	{
 		Location1.Y = Location2.Y = Y * MazeCellSize.Y;
-		OutlineWallCells->AddInstance(FTransform{Location1});
-		OutlineWallCells->AddInstance(FTransform{Location2});
+		Transforms.Emplace(Location1);
+		Transforms.Emplace(Location2);
 	}
+
+	OutlineWallCells->AddInstances(Transforms, false);
 }
 
-TArray<TArray<uint8>> AMaze::GetMazePath(const FMazeCoordinates& Start, const FMazeCoordinates& End, int32& OutLength)
+FMazeGrid AMaze::GetMazePath(const FMazeCoordinates& Start, const FMazeCoordinates& End, int32& OutLength)
 {
-	TArray<TArray<int32>> Graph;
-	Graph.Reserve(MazeGrid.Num() * MazeGrid[0].Num());
+	TBitArray<> PathCells;
+	if (!FindPath(Pathfinder, MazePassages, Start, End, PathfindingMode, PathCells, OutLength))
+	{
+		return FMazeGrid();
+	}
 
-	// Graph creation.
-	for (int32 GraphVertex,
-	           Y = 0; Y < MazeGrid.Num(); ++Y)
+	const FIntVector2 Size = MazePassages.GetMazeSize();
+	FMazeGrid Path(Size);
+	for (TConstSetBitIterator<> It(PathCells); It; ++It)
 	{
-		for (int32 X = 0; X < MazeGrid[Y].Num(); ++X)
-		{
-			GraphVertex = Y * MazeGrid[Y].Num() + X;
+		Path(It.GetIndex() % Size.X, It.GetIndex() / Size.X) = 1;
+	}
+	return Path;
+}
 
-			Graph.Emplace(TArray<int32>());
-			if (!MazeGrid[Y][X])
-			{
-				continue;
-			}
+bool AMaze::FindPath(FMazePathfinder& Pathfinder, const FMazePassages& Passages, const FMazeCoordinates& Start,
+                     const FMazeCoordinates& End, const EMazePathfindingMode Mode, TBitArray<>& OutPathCells,
+                     int32& OutLength)
+{
+	if (!Pathfinder.FindPath(Passages, FIntPoint(Start.X, Start.Y), FIntPoint(End.X, End.Y), Mode,
+	                         OutPathCells, OutLength))
+	{
+		UE_LOG(LogMaze, Warning, TEXT("Path is not reachable."));
+		return false;
+	}
+	return true;
+}
+
+int32 AMaze::GetPathLength(const FMazeCoordinates& Start, const FMazeCoordinates& End)
+{
+	if (PathTree.IsEmpty())
+	{
+		PathTree = FMazePathTree(MazePassages);
+		UpdateStats();
+	}
+	return PathTree.GetPathLength(FIntPoint(Start.X, Start.Y), FIntPoint(End.X, End.Y));
+}
 
-			Graph[GraphVertex].Reserve(4); // There are only 4 directions possible.
+TArray<FMazeCoordinates> AMaze::GetPath(const FMazeCoordinates& Start, const FMazeCoordinates& End)
+{
+	if (PathTree.IsEmpty())
+	{
+		PathTree = FMazePathTree(MazePassages);
+		UpdateStats();
+	}
 
-			if (X > 0 && MazeGrid[Y][X - 1]) // West direction.
-			{
-				Graph[GraphVertex].Emplace(GraphVertex - 1);
-			}
-			if (X + 1 < MazeGrid[Y].Num() && MazeGrid[Y][X + 1]) // East direction.
-			{
-				Graph[GraphVertex].Emplace(GraphVertex + 1);
-			}
-			if (Y > 0 && MazeGrid[Y - 1][X]) // North direction.
-			{
-				Graph[GraphVertex].Emplace(GraphVertex - MazeGrid[Y].Num());
-			}
-			if (Y + 1 < MazeGrid.Num() && MazeGrid[Y + 1][X]) // South direction.
-			{
-				Graph[GraphVertex].Emplace(GraphVertex + MazeGrid[Y].Num());
-			}
+	TArray<FIntPoint> Cells;
+	PathTree.GetPath(FIntPoint(Start.X, Start.Y), FIntPoint(End.X, End.Y), Cells);
 
-			Graph[GraphVertex].Shrink();
-		}
+	TArray<FMazeCoordinates> Path;
+	Path.SetNum(Cells.Num());
+	for (int32 Index = 0; Index < Cells.Num(); ++Index)
+	{
+		Path[Index].X = Cells[Index].X;
+		Path[Index].Y = Cells[Index].Y;
+	}
+	return Path;
+}
+
+void AMaze::BuildFlowField(const TArray<FMazeCoordinates>& Goals)
+{
+	TArray<FIntPoint> Cells;
+	Cells.Reserve(Goals.Num());
+	for (const FMazeCoordinates& Goal : Goals)
+	{
+		Cells.Emplace(Goal.X, Goal.Y);
 	}
+	FlowField.Build(MazePassages, Cells, true);
+	UpdateStats();
+}
 
-	const int32 StartVertex = Start.Y * MazeGrid[0].Num() + Start.X;
-	const int32 EndVertex = End.Y * MazeGrid[0].Num() + End.X;
+void AMaze::MoveFlowFieldGoal(const FMazeCoordinates& Goal)
+{
+	if (FlowField.IsEmpty())
+	{
+		BuildFlowField({Goal});
+		return;
+	}
+	FlowField.MoveGoal(FIntPoint(Goal.X, Goal.Y), FlowFieldIncrementalDistance, true);
+	UpdateStats();
+}
 
+int32 AMaze::GetFlowFieldDistance(const FMazeCoordinates& Cell) const
+{
+	return FlowField.IsEmpty() ? INDEX_NONE : FlowField.GetDistance(FIntPoint(Cell.X, Cell.Y));
+}
 
-	TQueue<int32> Vertices;
+FMazeCoordinates AMaze::GetFlowFieldNextCell(const FMazeCoordinates& Cell) const
+{
+	FMazeCoordinates NextCell = Cell;
+	if (!FlowField.IsEmpty())
+	{
+		const FIntPoint Step = FlowField.GetNextStep(FIntPoint(Cell.X, Cell.Y));
+		NextCell.X += Step.X;
+		NextCell.Y += Step.Y;
+	}
+	return NextCell;
+}
 
-	const int32 VerticesAmount = MazeGrid.Num() * MazeGrid[0].Num();
+TArray<uint8> AMaze::GetFlowFieldDirections() const
+{
+	return TArray<uint8>(FlowField.GetDirections());
+}
 
-	TArray<bool> Visited;
-	Visited.Init(false, VerticesAmount);
+FName AMaze::GetGenerationAlgorithmName() const
+{
+	return CustomGenerationAlgorithm.IsNone()
+		       ? FMazeAlgorithmRegistry::GetBuiltInName(GenerationAlgorithm)
+		       : CustomGenerationAlgorithm;
+}
 
-	TArray<int32> Parents;
-	Parents.Init(-1, VerticesAmount);
+TArray<FName> AMaze::GetGenerationAlgorithmNames()
+{
+	return FMazeAlgorithmRegistry::Get().GetKeys();
+}
 
-	TArray<int32> Distances;
-	Distances.Init(0, VerticesAmount);
+bool AMaze::SaveMazeToFile(const FString& FilePath) const
+{
+	FMazeFileContent Content;
+	Content.Seed = Seed;
+	Content.Algorithm = CustomGenerationAlgorithm.IsNone()
+		                    ? static_cast<uint8>(GenerationAlgorithm)
+		                    : FMazeFileHeader::CustomAlgorithm;
+	Content.bParallelGeneration = bParallelGeneration;
+	Content.GenerationTileSize = GenerationTileSize;
+	Content.CellSize = MazeCellSize;
+	Content.PathCells = &MazePathCells;
+	Content.PathLength = PathLength;
+	Content.Distances = FlowField.GetDistances();
+	Content.Directions = FlowField.GetDirections();
+
+	if (MazePassages.IsEmpty() || !FMazeFileWriter::Write(FilePath, MazePassages, Content))
+	{
+		UE_LOG(LogMaze, Warning, TEXT("Failed to save maze to %s."), *FilePath);
+		return false;
+	}
+	return true;
+}
 
-	int32 Vertex;
-	Vertices.Enqueue(StartVertex);
-	Visited[StartVertex] = true;
-	while (Vertices.Dequeue(Vertex))
+bool AMaze::GenerateMazeToFile(const FString& FilePath) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(AMaze::GenerateMazeToFile);
+
+	FMazeFileContent Content;
+	Content.Seed = Seed;
+	Content.Algorithm = CustomGenerationAlgorithm.IsNone()
+		                    ? static_cast<uint8>(GenerationAlgorithm)
+		                    : FMazeFileHeader::CustomAlgorithm;
+	Content.bParallelGeneration = bParallelGeneration;
+	Content.GenerationTileSize = GenerationTileSize;
+	Content.CellSize = GetMaxCellSize();
+
+	// Same options as MakeGenerationRequest, so the file holds the maze the actor generates.
+	FGenerationOptions Options;
+	Options.bParallel = bParallelGeneration;
+	Options.TileSize = GenerationTileSize / 2;
+
+	bool bWritten = false;
+	if (GetGenerationAlgorithmName() == FMazeAlgorithmRegistry::GetBuiltInName(EGenerationAlgorithm::Eller)
+		&& !Options.bParallel && Options.TileSize == 0)
 	{
-		for (int32 i = 0; i < Graph[Vertex].Num(); ++i)
+		// Same stream and directions grid size as Algorithm::GetPassages, so the maze matches the generated one.
+		FMazeFileRowWriter Writer;
+		if (Writer.Open(FilePath, MazeSize, Content))
 		{
-			if (const int32 Adjacent = Graph[Vertex][i]; !Visited[Adjacent])
-			{
-				Visited[Adjacent] = true;
-				Vertices.Enqueue(Adjacent);
-				Distances[Adjacent] = Distances[Vertex] + 1;
-				Parents[Adjacent] = Vertex;
-			}
+			Eller::GenerateRows((MazeSize.X + 1) / 2, (MazeSize.Y + 1) / 2, FRandomStream(Seed),
+			                    [&Writer](const int32 Y, const TArrayView<const uint8> Row)
+			                    {
+				                    Writer.WriteRow(Row);
+				                    return true;
+			                    });
+			bWritten = Writer.Close();
 		}
 	}
-
-	TArray<int32> GraphPath;
-	if (!Visited[EndVertex])
+	else if (const TSharedPtr<const Algorithm> GenerationAlgorithmPtr =
+		FMazeAlgorithmRegistry::Get().Find(GetGenerationAlgorithmName()))
 	{
-		UE_LOG(LogMaze, Warning, TEXT("Path is not reachable."));
-		return TArray<TArray<uint8>>();
+		bWritten = FMazeFileWriter::Write(FilePath, GenerationAlgorithmPtr->GetPassages(MazeSize, Seed, Options),
+		                                   Content);
 	}
 
-	for (int VertexNumber = EndVertex; VertexNumber != -1; VertexNumber = Parents[VertexNumber])
+	if (!bWritten)
 	{
-		GraphPath.Emplace(VertexNumber);
+		UE_LOG(LogMaze, Warning, TEXT("Failed to generate maze to %s."), *FilePath);
 	}
+	return bWritten;
+}
 
-	Algo::Reverse(GraphPath);
+bool AMaze::LoadMazeFromFile(const FString& FilePath)
+{
+	FMazeFileReader Reader;
+	if (!Reader.Open(FilePath))
+	{
+		UE_LOG(LogMaze, Warning, TEXT("%s is not a valid maze file."), *FilePath);
+		return false;
+	}
 
-	TArray<TArray<uint8>> Path;
-	Path.Init(TArray<uint8>(), MazeGrid.Num());
-	for (int Y = 0; Y < MazeGrid.Num(); ++Y)
+	CancelMazeGeneration();
+	if (!PrepareCells())
 	{
-		Path[Y].SetNumZeroed(MazeGrid[Y].Num());
+		return false;
 	}
 
-	for (int32 VertexNumber, i = 0; i < GraphPath.Num(); ++i)
+	const FMazeFileHeader& Header = Reader.GetHeader();
+	MazeSize.X = Header.SizeX;
+	MazeSize.Y = Header.SizeY;
+	Seed = Header.Seed;
+	bParallelGeneration = (Header.Flags & FMazeFileHeader::ParallelGeneration) != 0;
+	GenerationTileSize = FMath::Max(Header.GenerationTileSize, 0);
+	// Custom algorithm of the file is unknown, so the current one is kept.
+	if (Header.Algorithm < StaticEnum<EGenerationAlgorithm>()->NumEnums() - 1)
+	{
+		GenerationAlgorithm = static_cast<EGenerationAlgorithm>(Header.Algorithm);
+		CustomGenerationAlgorithm = NAME_None;
+	}
+	if (Header.CellSizeX > 0.f && Header.CellSizeY > 0.f)
 	{
-		VertexNumber = GraphPath[i];
+		MazeCellSize = FVector2D(Header.CellSizeX, Header.CellSizeY);
+	}
+	bGeneratePath = Reader.HasPath();
 
-		Path[VertexNumber / MazeGrid[0].Num()][VertexNumber % MazeGrid[0].Num()] = 1;
+	FMazeGenerationResult Result;
+	Result.Passages = Reader.GetPassages();
+	Result.PathCells = Reader.GetPathCells();
+	Result.PathLength = Header.PathLength;
+	Result.bGeneratePath = bGeneratePath;
+	BuildMaze(MoveTemp(Result));
+
+	if (Reader.HasDistances())
+	{
+		FlowField.Assign(MazePassages, Reader.GetDistances(), Reader.GetDirections());
+		UpdateStats();
 	}
+	return true;
+}
+
+FMazeGrid AMaze::GetMazeGrid() const
+{
+	return MazePassages.ToGrid();
+}
 
+FMazeGrid AMaze::GetMazePathGrid() const
+{
+	const FIntVector2 Size = MazePassages.GetMazeSize();
+	if (MazePathCells.Num() != Size.X * Size.Y)
+	{
+		return FMazeGrid();
+	}
 
-	OutLength = Distances[EndVertex] + 1;
+	FMazeGrid Path(Size);
+	for (TConstSetBitIterator<> It(MazePathCells); It; ++It)
+	{
+		Path(It.GetIndex() % Size.X, It.GetIndex() / Size.X) = 1;
+	}
 	return Path;
 }
 
 void AMaze::EnableCollision(const bool bShouldEnable)
 {
-	if (bShouldEnable)
-	{
-		FloorCells->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		WallCells->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		OutlineWallCells->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-		PathFloorCells->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
-	}
-	else
+	SCOPE_CYCLE_COUNTER(STAT_MazeEnableCollision);
+
+	const ECollisionEnabled::Type CollisionEnabled = bShouldEnable
+		                                                 ? ECollisionEnabled::QueryAndPhysics
+		                                                 : ECollisionEnabled::NoCollision;
+
+	FloorCells->SetCollisionEnabled(CollisionEnabled);
+	WallCells->SetCollisionEnabled(CollisionEnabled);
+	OutlineWallCells->SetCollisionEnabled(CollisionEnabled);
+	PathFloorCells->SetCollisionEnabled(CollisionEnabled);
+	for (const FMazeCellsChunk& Chunk : CellChunks)
 	{
-		FloorCells->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		WallCells->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		OutlineWallCells->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		PathFloorCells->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		if (IsValid(Chunk.FloorCells) && IsValid(Chunk.WallCells) && IsValid(Chunk.PathFloorCells))
+		{
+			Chunk.FloorCells->SetCollisionEnabled(CollisionEnabled);
+			Chunk.WallCells->SetCollisionEnabled(CollisionEnabled);
+			Chunk.PathFloorCells->SetCollisionEnabled(CollisionEnabled);
+		}
 	}
 }
 
@@ -315,7 +1320,69 @@ void AMaze::ClearMaze() const
 	WallCells->ClearInstances();
 	OutlineWallCells->ClearInstances();
 	PathFloorCells->ClearInstances();
+	for (const FMazeCellsChunk& Chunk : CellChunks)
+	{
+		if (IsValid(Chunk.FloorCells) && IsValid(Chunk.WallCells) && IsValid(Chunk.PathFloorCells))
+		{
+			Chunk.FloorCells->ClearInstances();
+			Chunk.WallCells->ClearInstances();
+			Chunk.PathFloorCells->ClearInstances();
+		}
+	}
+
+	UpdateStats();
+}
+
+void AMaze::UpdateStats() const
+{
+#if STATS
+	int64 FloorInstances = 0;
+	int64 WallInstances = 0;
+	int64 PathInstances = 0;
+	for (const FMazeCellsChunk& Chunk : CellChunks)
+	{
+		if (IsValid(Chunk.FloorCells) && IsValid(Chunk.WallCells) && IsValid(Chunk.PathFloorCells))
+		{
+			FloorInstances += Chunk.FloorCells->GetInstanceCount();
+			WallInstances += Chunk.WallCells->GetInstanceCount();
+			PathInstances += Chunk.PathFloorCells->GetInstanceCount();
+		}
+	}
+
+	const int64 Values[ReportedStatsAmount] = {
+		static_cast<int64>(MazePassages.GetAllocatedSize()),
+		static_cast<int64>(MazePathCells.GetAllocatedSize() + PathTree.GetAllocatedSize()
+			+ Pathfinder.GetAllocatedSize()),
+		static_cast<int64>(FlowField.GetAllocatedSize()),
+		FloorInstances,
+		WallInstances,
+		PathInstances,
+		OutlineWallCells ? OutlineWallCells->GetInstanceCount() : 0
+	};
+	ReportStats(Values);
+#endif
+}
+
+#if STATS
+void AMaze::ReportStats(const int64 (&Values)[ReportedStatsAmount]) const
+{
+	int64 Deltas[ReportedStatsAmount];
+	for (int32 Index = 0; Index < ReportedStatsAmount; ++Index)
+	{
+		Deltas[Index] = Values[Index] - ReportedStats[Index];
+		ReportedStats[Index] = Values[Index];
+	}
+
+	// Deltas may be negative, adding them keeps counters equal to sums over all mazes.
+	INC_MEMORY_STAT_BY(STAT_MazePassagesMemory, Deltas[0]);
+	INC_MEMORY_STAT_BY(STAT_MazePathMemory, Deltas[1]);
+	INC_MEMORY_STAT_BY(STAT_MazeFlowFieldMemory, Deltas[2]);
+	INC_DWORD_STAT_BY(STAT_MazeFloorInstances, Deltas[3]);
+	INC_DWORD_STAT_BY(STAT_MazeWallInstances, Deltas[4]);
+	INC_DWORD_STAT_BY(STAT_MazePathInstances, Deltas[5]);
+	INC_DWORD_STAT_BY(STAT_MazeOutlineInstances, Deltas[6]);
 }
+#endif
 
 FVector2D AMaze::GetMaxCellSize() const
 {
@@ -343,9 +1410,21 @@ void AMaze::Randomize()
 	MazeSize.X = FMath::RandRange(3, 101) | 1; // | 1 to make odd.
 	MazeSize.Y = FMath::RandRange(3, 101) | 1;
 
-	TArray<EGenerationAlgorithm> Algorithms;
-	const int32 Num = GenerationAlgorithms.GetKeys(Algorithms);
-	GenerationAlgorithm = Algorithms[FMath::RandRange(0, Num - 1)];
+	const TArray<FName> Algorithms = FMazeAlgorithmRegistry::Get().GetKeys();
+	if (!Algorithms.IsEmpty())
+	{
+		const FName Algorithm = Algorithms[FMath::RandRange(0, Algorithms.Num() - 1)];
+		const int64 BuiltInAlgorithm = StaticEnum<EGenerationAlgorithm>()->GetValueByNameString(Algorithm.ToString());
+		if (BuiltInAlgorithm != INDEX_NONE)
+		{
+			GenerationAlgorithm = static_cast<EGenerationAlgorithm>(BuiltInAlgorithm);
+			CustomGenerationAlgorithm = NAME_None;
+		}
+		else
+		{
+			CustomGenerationAlgorithm = Algorithm;
+		}
+	}
 
 	Seed = FMath::RandRange(MIN_int32, MAX_int32);
 
@@ -358,6 +1437,99 @@ void AMaze::Randomize()
 }
 
 
+void AMaze::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelMazeGeneration();
+#if WITH_EDITOR
+	FTSTicker::GetCoreTicker().RemoveTicker(EditCommitHandle);
+	EditCommitHandle.Reset();
+#endif
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMaze::BeginDestroy()
+{
+#if STATS
+	constexpr int64 Zeros[ReportedStatsAmount] = {};
+	ReportStats(Zeros);
+#endif
+
+	Super::BeginDestroy();
+}
+
+#if WITH_EDITOR
+void AMaze::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		return;
+	}
+
+	if (bBakeMazeData)
+	{
+		BakeMazeData();
+	}
+	else
+	{
+		BakedMazeData = nullptr;
+	}
+}
+
+void AMaze::BakeMazeData()
+{
+	// Instances must describe current parameters, not the previous maze.
+	if (IsGeneratingMaze())
+	{
+		UpdateMaze();
+	}
+
+	if (MazePassages.IsEmpty() || MazePassages.GetMazeSize() != FIntVector2(MazeSize))
+	{
+		BakedMazeData = nullptr;
+		return;
+	}
+
+	if (!BakedMazeData)
+	{
+		BakedMazeData = NewObject<UMazeDataAsset>(this);
+	}
+
+	BakedMazeData->InputsHash = GetBakeInputsHash();
+	BakedMazeData->MazeSize = FIntPoint(MazeSize.X, MazeSize.Y);
+	BakedMazeData->PathLength = PathLength;
+	BakedMazeData->PassageWords = MazePassages.GetWords();
+	BakedMazeData->PathWords.Reset();
+	if (!MazePathCells.IsEmpty())
+	{
+		BakedMazeData->PathWords.Append(MazePathCells.GetData(), FMath::DivideAndRoundUp(MazePathCells.Num(), 32));
+	}
+
+	auto GetTransforms = [](const UHierarchicalInstancedStaticMeshComponent* Component)
+	{
+		TArray<FTransform> Transforms;
+		Transforms.SetNumUninitialized(Component->GetInstanceCount());
+		for (int32 Index = 0; Index < Transforms.Num(); ++Index)
+		{
+			Component->GetInstanceTransform(Index, Transforms[Index], false);
+		}
+		return Transforms;
+	};
+
+	BakedMazeData->OutlineTransforms = GetTransforms(OutlineWallCells);
+	BakedMazeData->Chunks.Reset(CellChunks.Num());
+	for (const FMazeCellsChunk& Chunk : CellChunks)
+	{
+		FMazeBakedChunk& BakedChunk = BakedMazeData->Chunks.AddDefaulted_GetRef();
+		BakedChunk.FloorTransforms = GetTransforms(Chunk.FloorCells);
+		BakedChunk.WallTransforms = GetTransforms(Chunk.WallCells);
+		BakedChunk.PathTransforms = GetTransforms(Chunk.PathFloorCells);
+	}
+}
+#endif
+
 void AMaze::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
@@ -365,10 +1537,139 @@ void AMaze::OnConstruction(const FTransform& Transform)
 #if WITH_EDITOR
 	if (Transform.Equals(LastMazeTransform))
 	{
-#endif
-		UpdateMaze();
-#if WITH_EDITOR
+		UpdateEditedMaze();
 	}
 	LastMazeTransform = Transform;
+#else
+	UpdateChangedMaze();
 #endif
 }
+
+#if WITH_EDITOR
+void AMaze::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	bEditingProperty = true;
+	bInteractiveEdit = PropertyChangedEvent.ChangeType == EPropertyChangeType::Interactive;
+
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bEditingProperty = bInteractiveEdit = false;
+}
+
+void AMaze::UpdateEditedMaze()
+{
+	// Edits which don't regenerate maze are cheap enough to be applied right away.
+	const bool bSameGeneration = BuiltParameters && BuiltParameters->HasSameGeneration(GetBuildParameters());
+	if (!bEditorPreview || !bEditingProperty || bSameGeneration)
+	{
+		UpdateChangedMaze();
+		return;
+	}
+
+	if (bInteractiveEdit)
+	{
+		DrawEditorPreview();
+		ScheduleEditCommit();
+	}
+	else
+	{
+		CommitEdit();
+	}
+}
+
+void AMaze::DrawEditorPreview()
+{
+	const TSharedPtr<const Algorithm> PreviewAlgorithm =
+		FMazeAlgorithmRegistry::Get().Find(GetGenerationAlgorithmName());
+	if (!(FloorStaticMesh && WallStaticMesh && PreviewAlgorithm))
+	{
+		return;
+	}
+
+	if (!EditorPreviewLines)
+	{
+		EditorPreviewLines = NewObject<ULineBatchComponent>(this, NAME_None, RF_Transient);
+		EditorPreviewLines->RegisterComponent();
+	}
+	EditorPreviewLines->Flush();
+
+	// Rounded down to odd, so preview has walls on its borders even if the maze size is even.
+	constexpr int32 MaxPreviewSize = 127;
+	const FIntVector2 PreviewSize{
+		(FMath::Min(MazeSize.X, MaxPreviewSize) - 1) | 1, (FMath::Min(MazeSize.Y, MaxPreviewSize) - 1) | 1
+	};
+	const FMazePassages Passages = PreviewAlgorithm->GetPassages(PreviewSize, Seed);
+
+	const FVector2D CellSize = GetMaxCellSize();
+	const FVector2D Scale = FVector2D(MazeSize.X, MazeSize.Y) / FVector2D(PreviewSize.X, PreviewSize.Y) * CellSize;
+	const FTransform& ActorTransform = GetActorTransform();
+	auto GetLocation = [&](const double X, const double Y)
+	{
+		return ActorTransform.TransformPosition(
+			FVector((X + 0.5) * Scale.X - CellSize.X / 2, (Y + 0.5) * Scale.Y - CellSize.Y / 2, 0.));
+	};
+
+	const float Thickness = FMath::Min(Scale.X, Scale.Y) / 4;
+	TArray<FBatchedLine> Lines;
+	Lines.Reserve(Passages.GetWidth() * Passages.GetHeight() + 4);
+	for (int32 Y = 0; Y < Passages.GetHeight(); ++Y)
+	{
+		for (int32 X = 0; X < Passages.GetWidth(); ++X)
+		{
+			const FVector Location = GetLocation(X * 2, Y * 2);
+			if (Passages.HasEast(X, Y))
+			{
+				Lines.Emplace(Location, GetLocation(X * 2 + 2, Y * 2), FLinearColor::Green, 0.f, Thickness, SDPG_World);
+			}
+			if (Passages.HasSouth(X, Y))
+			{
+				Lines.Emplace(Location, GetLocation(X * 2, Y * 2 + 2), FLinearColor::Green, 0.f, Thickness, SDPG_World);
+			}
+		}
+	}
+
+	const FVector Corners[] = {
+		GetLocation(-0.5, -0.5), GetLocation(PreviewSize.X - 0.5, -0.5),
+		GetLocation(PreviewSize.X - 0.5, PreviewSize.Y - 0.5), GetLocation(-0.5, PreviewSize.Y - 0.5)
+	};
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		Lines.Emplace(Corners[Index], Corners[(Index + 1) % 4], FLinearColor::White, 0.f, Thickness, SDPG_World);
+	}
+
+	EditorPreviewLines->DrawLines(Lines);
+}
+
+void AMaze::ClearEditorPreview() const
+{
+	if (EditorPreviewLines)
+	{
+		EditorPreviewLines->Flush();
+	}
+}
+
+void AMaze::ScheduleEditCommit()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(EditCommitHandle);
+	EditCommitHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this](float)
+	{
+		EditCommitHandle.Reset();
+		CommitEdit();
+		return false;
+	}), EditorPreviewDelay);
+}
+
+void AMaze::CommitEdit()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(EditCommitHandle);
+	EditCommitHandle.Reset();
+
+	UpdateChangedMaze(true);
+
+	// Otherwise preview is kept until the regenerated maze replaces it.
+	if (!IsGeneratingMaze())
+	{
+		ClearEditorPreview();
+	}
+}
+#endif
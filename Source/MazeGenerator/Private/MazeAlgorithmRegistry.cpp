@@ -0,0 +1,72 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeAlgorithmRegistry.h"
+
+#include "Maze.h"
+#include "Algorithms/Backtracker.h"
+#include "Algorithms/BinaryTree.h"
+#include "Algorithms/Division.h"
+#include "Algorithms/Eller.h"
+#include "Algorithms/HaK.h"
+#include "Algorithms/Kruskal.h"
+#include "Algorithms/Prim.h"
+#include "Algorithms/Sidewinder.h"
+
+#include "Misc/ScopeRWLock.h"
+
+FMazeAlgorithmRegistry& FMazeAlgorithmRegistry::Get()
+{
+	static FMazeAlgorithmRegistry Registry;
+	return Registry;
+}
+
+FName FMazeAlgorithmRegistry::GetBuiltInName(const EGenerationAlgorithm BuiltInAlgorithm)
+{
+	return FName(StaticEnum<EGenerationAlgorithm>()->GetNameStringByValue(static_cast<int64>(BuiltInAlgorithm)));
+}
+
+FMazeAlgorithmRegistry::FMazeAlgorithmRegistry()
+{
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::Backtracker), MakeShared<Backtracker>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::Division), MakeShared<Division>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::HaK), MakeShared<HaK>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::Sidewinder), MakeShared<Sidewinder>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::Kruskal), MakeShared<Kruskal>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::Eller), MakeShared<Eller>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::Prim), MakeShared<Prim>());
+	Algorithms.Add(GetBuiltInName(EGenerationAlgorithm::BinaryTree), MakeShared<BinaryTree>());
+}
+
+TSharedPtr<const Algorithm> FMazeAlgorithmRegistry::Find(const FName Key) const
+{
+	FReadScopeLock ReadLock(Lock);
+	const TSharedRef<const Algorithm>* Found = Algorithms.Find(Key);
+	return Found ? TSharedPtr<const Algorithm>(*Found) : nullptr;
+}
+
+bool FMazeAlgorithmRegistry::Contains(const FName Key) const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Algorithms.Contains(Key);
+}
+
+void FMazeAlgorithmRegistry::Register(const FName Key, const TSharedRef<const Algorithm>& InAlgorithm)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Algorithms.Add(Key, InAlgorithm);
+}
+
+void FMazeAlgorithmRegistry::Unregister(const FName Key)
+{
+	FWriteScopeLock WriteLock(Lock);
+	Algorithms.Remove(Key);
+}
+
+TArray<FName> FMazeAlgorithmRegistry::GetKeys() const
+{
+	FReadScopeLock ReadLock(Lock);
+	TArray<FName> Keys;
+	Algorithms.GetKeys(Keys);
+	return Keys;
+}
@@ -0,0 +1,294 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeBenchmarkCommandlet.h"
+
+#include "Maze.h"
+#include "MazeAlgorithmRegistry.h"
+#include "Algorithms/Algorithm.h"
+
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMazeBenchmark, Log, All);
+
+namespace
+{
+	double GetMedian(TArray<double>& Times)
+	{
+		Times.Sort();
+		return Times.IsEmpty() ? 0.0 : Times[Times.Num() / 2];
+	}
+
+	UStaticMesh* LoadMesh(const FString& Params, const TCHAR* Switch, const TCHAR* DefaultPath)
+	{
+		FString Path = DefaultPath;
+		FParse::Value(*Params, Switch, Path);
+		UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, *Path);
+		return Mesh ? Mesh : LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	}
+}
+
+UMazeBenchmarkCommandlet::UMazeBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMazeBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<FName> Algorithms;
+	FString AlgorithmsParam;
+	if (FParse::Value(*Params, TEXT("Algorithms="), AlgorithmsParam, false))
+	{
+		TArray<FString> Names;
+		AlgorithmsParam.ParseIntoArray(Names, TEXT("+"));
+		for (const FString& Name : Names)
+		{
+			if (!FMazeAlgorithmRegistry::Get().Contains(FName(Name)))
+			{
+				UE_LOG(LogMazeBenchmark, Error, TEXT("Unknown algorithm %s."), *Name);
+				return 1;
+			}
+			Algorithms.Add(FName(Name));
+		}
+	}
+	else
+	{
+		Algorithms = FMazeAlgorithmRegistry::Get().GetKeys();
+	}
+
+	TArray<int32> Sizes;
+	FString SizesParam = TEXT("101+501+1001");
+	FParse::Value(*Params, TEXT("Sizes="), SizesParam, false);
+	TArray<FString> SizeStrings;
+	SizesParam.ParseIntoArray(SizeStrings, TEXT("+"));
+	for (const FString& SizeString : SizeStrings)
+	{
+		Sizes.Add(FMath::Clamp(FCString::Atoi(*SizeString), 3, 9999));
+	}
+
+	int32 Iterations = 5;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	AMaze* Maze = World->SpawnActor<AMaze>();
+	Maze->FloorStaticMesh = LoadMesh(Params, TEXT("FloorMesh="), TEXT("/MazeGenerator/Meshes/SM_Floor.SM_Floor"));
+	Maze->WallStaticMesh = LoadMesh(Params, TEXT("WallMesh="), TEXT("/MazeGenerator/Meshes/SM_Wall.SM_Wall"));
+	Maze->PathStaticMesh = LoadMesh(Params, TEXT("PathMesh="), TEXT("/MazeGenerator/Meshes/SM_Path.SM_Path"));
+	Maze->bGeneratePath = true;
+
+	TArray<FBenchmarkResult> Results;
+	for (const FName GenerationAlgorithm : Algorithms)
+	{
+		for (const int32 Size : Sizes)
+		{
+			FBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+			Result.Algorithm = GenerationAlgorithm.ToString();
+			Result.Size = Size;
+
+			Maze->CustomGenerationAlgorithm = GenerationAlgorithm;
+			Maze->MazeSize.X = Maze->MazeSize.Y = Size;
+			Maze->PathStart = FMazeCoordinates();
+			Maze->PathEnd.X = Maze->PathEnd.Y = Size - 1;
+
+			TArray<double> GenerationTimes;
+			TArray<double> ExpansionTimes;
+			TArray<double> PathTimes;
+			TArray<double> InstancesTimes;
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Maze->Seed = Iteration;
+				Maze->PrepareCells();
+				const FMazeGenerationRequest Request = Maze->MakeGenerationRequest();
+
+				FMazeGenerationResult GenerationResult;
+				GenerationResult.bGeneratePath = Request.bGeneratePath;
+				double StartTime = FPlatformTime::Seconds();
+				GenerationResult.Passages = Request.GenerationAlgorithm->GetPassages(Request.Size, Request.Seed);
+				GenerationTimes.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+				StartTime = FPlatformTime::Seconds();
+				const FMazeGrid Grid = GenerationResult.Passages.ToGrid();
+				ExpansionTimes.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+				FMazePathfinder Pathfinder;
+				StartTime = FPlatformTime::Seconds();
+				AMaze::FindPath(Pathfinder, GenerationResult.Passages, Request.PathStart, Request.PathEnd,
+				                Request.PathfindingMode, GenerationResult.PathCells, GenerationResult.PathLength);
+				PathTimes.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+				Result.PassagesBytes = GenerationResult.Passages.GetAllocatedSize();
+				int64 MemoryBytes = Result.PassagesBytes + Grid.GetAllocatedSize()
+					+ GenerationResult.PathCells.GetAllocatedSize() + Pathfinder.GetAllocatedSize();
+
+				// Instances of previous iteration are cleared, so every iteration builds all of them.
+				Maze->ClearMaze();
+				StartTime = FPlatformTime::Seconds();
+				Maze->BuildMaze(MoveTemp(GenerationResult));
+				InstancesTimes.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+				// Everything above is still alive here, so their sum is the peak of this iteration.
+				for (const UHierarchicalInstancedStaticMeshComponent* Component : Maze->GetCellComponents())
+				{
+					MemoryBytes += Component->PerInstanceSMData.GetAllocatedSize();
+				}
+				Result.PeakMemoryBytes = FMath::Max(Result.PeakMemoryBytes, MemoryBytes);
+			}
+
+			Result.GenerationTime = GetMedian(GenerationTimes);
+			Result.ExpansionTime = GetMedian(ExpansionTimes);
+			Result.PathTime = GetMedian(PathTimes);
+			Result.InstancesTime = GetMedian(InstancesTimes);
+			Result.Instances = 0;
+			for (const FMazeCellsChunk& Chunk : Maze->CellChunks)
+			{
+				Result.Instances += Chunk.FloorCells->GetInstanceCount() + Chunk.WallCells->GetInstanceCount()
+					+ Chunk.PathFloorCells->GetInstanceCount();
+			}
+
+			UE_LOG(LogMazeBenchmark, Display,
+			       TEXT("%s %dx%d: generation %.3f ms, expansion %.3f ms, path %.3f ms, instances %.3f ms(%d)"),
+			       *Result.Algorithm, Size, Size, Result.GenerationTime, Result.ExpansionTime, Result.PathTime,
+			       Result.InstancesTime, Result.Instances);
+		}
+	}
+
+	Maze->Destroy();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	FString OutputPath;
+	if (FParse::Value(*Params, TEXT("Output="), OutputPath))
+	{
+		const bool bCSV = FPaths::GetExtension(OutputPath).Equals(TEXT("csv"), ESearchCase::IgnoreCase);
+		if (!FFileHelper::SaveStringToFile(bCSV ? ToCSV(Results) : ToJSON(Results), *OutputPath))
+		{
+			UE_LOG(LogMazeBenchmark, Error, TEXT("Failed to write %s."), *OutputPath);
+			return 1;
+		}
+	}
+
+	FString BaselinePath;
+	if (FParse::Value(*Params, TEXT("Baseline="), BaselinePath))
+	{
+		FString BaselineJSON;
+		if (!FFileHelper::LoadFileToString(BaselineJSON, *BaselinePath))
+		{
+			UE_LOG(LogMazeBenchmark, Error, TEXT("Failed to read %s."), *BaselinePath);
+			return 1;
+		}
+
+		double Tolerance = 0.1;
+		FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+		double MinDelta = 0.5;
+		FParse::Value(*Params, TEXT("MinDeltaMs="), MinDelta);
+		if (CompareWithBaseline(Results, BaselineJSON, Tolerance, MinDelta) > 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+FString UMazeBenchmarkCommandlet::ToCSV(const TArray<FBenchmarkResult>& Results)
+{
+	FString CSV = TEXT(
+		"Algorithm,Size,GenerationMs,ExpansionMs,PathMs,InstancesMs,PassagesBytes,Instances,PeakMemoryBytes\n");
+	for (const FBenchmarkResult& Result : Results)
+	{
+		CSV += FString::Printf(TEXT("%s,%d,%.4f,%.4f,%.4f,%.4f,%lld,%d,%lld\n"),
+		                       *Result.Algorithm, Result.Size, Result.GenerationTime, Result.ExpansionTime,
+		                       Result.PathTime, Result.InstancesTime, Result.PassagesBytes, Result.Instances,
+		                       Result.PeakMemoryBytes);
+	}
+	return CSV;
+}
+
+FString UMazeBenchmarkCommandlet::ToJSON(const TArray<FBenchmarkResult>& Results)
+{
+	TArray<TSharedPtr<FJsonValue>> Values;
+	for (const FBenchmarkResult& Result : Results)
+	{
+		const TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("Algorithm"), Result.Algorithm);
+		Object->SetNumberField(TEXT("Size"), Result.Size);
+		Object->SetNumberField(TEXT("GenerationMs"), Result.GenerationTime);
+		Object->SetNumberField(TEXT("ExpansionMs"), Result.ExpansionTime);
+		Object->SetNumberField(TEXT("PathMs"), Result.PathTime);
+		Object->SetNumberField(TEXT("InstancesMs"), Result.InstancesTime);
+		Object->SetNumberField(TEXT("PassagesBytes"), Result.PassagesBytes);
+		Object->SetNumberField(TEXT("Instances"), Result.Instances);
+		Object->SetNumberField(TEXT("PeakMemoryBytes"), Result.PeakMemoryBytes);
+		Values.Add(MakeShared<FJsonValueObject>(Object));
+	}
+
+	const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetArrayField(TEXT("Results"), Values);
+
+	FString JSON;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JSON);
+	FJsonSerializer::Serialize(Root, Writer);
+	return JSON;
+}
+
+int32 UMazeBenchmarkCommandlet::CompareWithBaseline(const TArray<FBenchmarkResult>& Results,
+                                                    const FString& BaselineJSON, const double Tolerance,
+                                                    const double MinDelta)
+{
+	TSharedPtr<FJsonObject> Root;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(BaselineJSON), Root) || !Root.IsValid())
+	{
+		UE_LOG(LogMazeBenchmark, Error, TEXT("Baseline is not a valid benchmark output."));
+		return 1;
+	}
+
+	int32 Regressions = 0;
+	for (const TSharedPtr<FJsonValue>& Value : Root->GetArrayField(TEXT("Results")))
+	{
+		const TSharedPtr<FJsonObject>& Baseline = Value->AsObject();
+		const FBenchmarkResult* Result = Results.FindByPredicate([&Baseline](const FBenchmarkResult& Candidate)
+		{
+			return Candidate.Algorithm == Baseline->GetStringField(TEXT("Algorithm"))
+				&& Candidate.Size == static_cast<int32>(Baseline->GetNumberField(TEXT("Size")));
+		});
+		if (!Result)
+		{
+			continue;
+		}
+
+		const TPair<const TCHAR*, double> Phases[] = {
+			{TEXT("GenerationMs"), Result->GenerationTime},
+			{TEXT("ExpansionMs"), Result->ExpansionTime},
+			{TEXT("PathMs"), Result->PathTime},
+			{TEXT("InstancesMs"), Result->InstancesTime}
+		};
+		for (const TPair<const TCHAR*, double>& Phase : Phases)
+		{
+			const double BaselineTime = Baseline->GetNumberField(Phase.Key);
+			// Sub-millisecond phases are dominated by timer noise, so small absolute differences are ignored.
+			if (Phase.Value > BaselineTime * (1.0 + Tolerance) && Phase.Value - BaselineTime > MinDelta)
+			{
+				UE_LOG(LogMazeBenchmark, Error, TEXT("%s %d %s regressed: %.3f ms, baseline %.3f ms."),
+				       *Result->Algorithm, Result->Size, Phase.Key, Phase.Value, BaselineTime);
+				++Regressions;
+			}
+		}
+	}
+	return Regressions;
+}
@@ -0,0 +1,59 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeDataAsset.h"
+
+#include "Serialization/CustomVersion.h"
+
+// Versions of bulk data of baked mazes.
+struct FMazeDataAssetVersion
+{
+	enum Type
+	{
+		Initial = 0,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+const FGuid FMazeDataAssetVersion::GUID(0x6A1C3E52, 0x4F8B4D07, 0x9B2E71C4, 0xD35A0F88);
+
+static FCustomVersionRegistration GRegisterMazeDataAssetVersion(FMazeDataAssetVersion::GUID,
+                                                                FMazeDataAssetVersion::LatestVersion,
+                                                                TEXT("MazeDataAsset"));
+
+void UMazeDataAsset::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FMazeDataAssetVersion::GUID);
+
+	PassageWords.BulkSerialize(Ar);
+	PathWords.BulkSerialize(Ar);
+	Ar << OutlineTransforms;
+	Ar << Chunks;
+}
+
+FMazePassages UMazeDataAsset::GetPassages() const
+{
+	return FMazePassages(FIntVector2(MazeSize.X, MazeSize.Y), PassageWords);
+}
+
+TBitArray<> UMazeDataAsset::GetPathCells() const
+{
+	TBitArray<> PathCells;
+	if (!PathWords.IsEmpty())
+	{
+		PathCells.Init(false, MazeSize.X * MazeSize.Y);
+		FMemory::Memcpy(PathCells.GetData(), PathWords.GetData(),
+		                FMath::Min(PathWords.Num(), FMath::DivideAndRoundUp(PathCells.Num(), 32)) * sizeof(uint32));
+		if (const int32 UsedBits = PathCells.Num() % 32)
+		{
+			PathCells.GetData()[PathCells.Num() / 32] &= (1u << UsedBits) - 1;
+		}
+	}
+	return PathCells;
+}
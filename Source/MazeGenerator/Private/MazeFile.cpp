@@ -0,0 +1,341 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeFile.h"
+
+#include "Algorithms/Algorithm.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Maze files are stored little-endian and read without conversion.");
+
+namespace
+{
+	// Same limit as maze size of the actor, keeps all amounts within int32.
+	constexpr int32 MaxSize = 9999;
+
+	int32 GetPathWordsAmount(const int32 SizeX, const int32 SizeY)
+	{
+		return FMath::DivideAndRoundUp(SizeX * SizeY, 32);
+	}
+}
+
+bool FMazeFileWriter::Write(const FString& Path, const FMazePassages& Passages, const FMazeFileContent& Content)
+{
+	const FIntVector2 Size = Passages.GetMazeSize();
+	const int32 CellsAmount = Passages.GetWidth() * Passages.GetHeight();
+	const bool bHasPath = Content.PathCells && Content.PathCells->Num() == Size.X * Size.Y;
+	const bool bHasDistances = Content.Distances.Num() == CellsAmount && Content.Directions.Num() == CellsAmount;
+
+	FMazeFileHeader Header;
+	Header.SizeX = Size.X;
+	Header.SizeY = Size.Y;
+	Header.Seed = Content.Seed;
+	Header.Algorithm = Content.Algorithm;
+	Header.Flags = Content.bParallelGeneration ? FMazeFileHeader::ParallelGeneration : 0;
+	Header.GenerationTileSize = Content.GenerationTileSize;
+	Header.CellSizeX = Content.CellSize.X;
+	Header.CellSizeY = Content.CellSize.Y;
+
+	uint32 Offset = sizeof(FMazeFileHeader);
+	Header.PassagesOffset = Offset;
+	Offset += Passages.GetWords().Num() * sizeof(uint64);
+	if (bHasPath)
+	{
+		Header.Flags |= FMazeFileHeader::HasPath;
+		Header.PathLength = Content.PathLength;
+		Header.PathOffset = Offset;
+		Offset += GetPathWordsAmount(Size.X, Size.Y) * sizeof(uint32);
+	}
+	if (bHasDistances)
+	{
+		Header.Flags |= FMazeFileHeader::HasDistances;
+		Header.DistancesOffset = Offset;
+		Offset += CellsAmount * sizeof(int32);
+		Header.DirectionsOffset = Offset;
+	}
+
+	const TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer)
+	{
+		return false;
+	}
+
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Serialize(const_cast<uint64*>(Passages.GetWords().GetData()), Passages.GetWords().Num() * sizeof(uint64));
+	if (bHasPath)
+	{
+		Writer->Serialize(const_cast<uint32*>(Content.PathCells->GetData()),
+		                  GetPathWordsAmount(Size.X, Size.Y) * sizeof(uint32));
+	}
+	if (bHasDistances)
+	{
+		Writer->Serialize(const_cast<int32*>(Content.Distances.GetData()), CellsAmount * sizeof(int32));
+		Writer->Serialize(const_cast<uint8*>(Content.Directions.GetData()), CellsAmount);
+	}
+	return Writer->Close();
+}
+
+bool FMazeFileRowWriter::Open(const FString& Path, const FIntVector2& MazeSize, const FMazeFileContent& Content)
+{
+	check(!Writer);
+
+	Width = (MazeSize.X + 1) / 2;
+	RowsLeft = (MazeSize.Y + 1) / 2;
+	Word = 0;
+	WordBits = 0;
+
+	FMazeFileHeader Header;
+	Header.SizeX = MazeSize.X;
+	Header.SizeY = MazeSize.Y;
+	Header.Seed = Content.Seed;
+	Header.Algorithm = Content.Algorithm;
+	Header.Flags = Content.bParallelGeneration ? FMazeFileHeader::ParallelGeneration : 0;
+	Header.GenerationTileSize = Content.GenerationTileSize;
+	Header.CellSizeX = Content.CellSize.X;
+	Header.CellSizeY = Content.CellSize.Y;
+	Header.PassagesOffset = sizeof(FMazeFileHeader);
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer)
+	{
+		return false;
+	}
+	Writer->Serialize(&Header, sizeof(Header));
+	return true;
+}
+
+void FMazeFileRowWriter::WriteRow(TArrayView<const uint8> Directions)
+{
+	check(Writer && RowsLeft > 0 && Directions.Num() == Width);
+	--RowsLeft;
+
+	// Same layout as FMazePassages: East and South bits of every cell.
+	for (const uint8 CellDirections : Directions)
+	{
+		const uint64 Bits = (CellDirections & static_cast<uint8>(EDirection::East) ? 1 : 0)
+			| (CellDirections & static_cast<uint8>(EDirection::South) ? 2 : 0);
+		Word |= Bits << WordBits;
+		WordBits += 2;
+		if (WordBits == 64)
+		{
+			Writer->Serialize(&Word, sizeof(Word));
+			Word = 0;
+			WordBits = 0;
+		}
+	}
+}
+
+bool FMazeFileRowWriter::Close()
+{
+	if (!Writer)
+	{
+		return false;
+	}
+	if (WordBits)
+	{
+		Writer->Serialize(&Word, sizeof(Word));
+	}
+	const bool bComplete = RowsLeft == 0;
+	const bool bClosed = Writer->Close();
+	Writer.Reset();
+	return bComplete && bClosed;
+}
+
+FMazeFileReader::FMazeFileReader() = default;
+
+FMazeFileReader::~FMazeFileReader()
+{
+	Close();
+}
+
+bool FMazeFileReader::Open(const FString& Path)
+{
+	Close();
+
+	MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (MappedHandle)
+	{
+		MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+	}
+	if (MappedRegion)
+	{
+		Data = MappedRegion->GetMappedPtr();
+		DataSize = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(Buffer, *Path, FILEREAD_Silent))
+	{
+		Data = Buffer.GetData();
+		DataSize = Buffer.Num();
+	}
+
+	if (!Data || DataSize < static_cast<int64>(sizeof(FMazeFileHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	// Every block has to lie within the file, so accessors never read past its end.
+	const FMazeFileHeader& Header = GetHeader();
+	const int64 CellsAmount = static_cast<int64>(GetDirectionsCellsAmount());
+	auto IsBlockValid = [this](const uint32 Offset, const int64 Bytes, const int32 Alignment)
+	{
+		return Offset >= sizeof(FMazeFileHeader) && Offset % Alignment == 0 && Offset + Bytes <= DataSize;
+	};
+	bool bValid = Header.Magic == FMazeFileHeader::MagicNumber && Header.Version == FMazeFileHeader::CurrentVersion
+		&& Header.SizeX > 0 && Header.SizeY > 0 && Header.SizeX <= MaxSize && Header.SizeY <= MaxSize
+		&& IsBlockValid(Header.PassagesOffset, FMath::DivideAndRoundUp(CellsAmount * 2, 64ll) * 8, 8);
+	if (bValid && HasPath())
+	{
+		bValid = IsBlockValid(Header.PathOffset, GetPathWordsAmount(Header.SizeX, Header.SizeY) * 4ll, 4);
+	}
+	if (bValid && HasDistances())
+	{
+		bValid = IsBlockValid(Header.DistancesOffset, CellsAmount * 4, 4)
+			&& IsBlockValid(Header.DirectionsOffset, CellsAmount, 1);
+	}
+
+	if (!bValid || !IsContentValid())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FMazeFileReader::Close()
+{
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	Buffer.Empty();
+	Data = nullptr;
+	DataSize = 0;
+}
+
+TArrayView<const uint64> FMazeFileReader::GetPassageWords() const
+{
+	const int32 WordsAmount = FMath::DivideAndRoundUp(GetDirectionsCellsAmount() * 2, 64);
+	return TArrayView<const uint64>(reinterpret_cast<const uint64*>(Data + GetHeader().PassagesOffset), WordsAmount);
+}
+
+FMazePassages FMazeFileReader::GetPassages() const
+{
+	return FMazePassages(FIntVector2(GetHeader().SizeX, GetHeader().SizeY), GetPassageWords());
+}
+
+TBitArray<> FMazeFileReader::GetPathCells() const
+{
+	TBitArray<> PathCells;
+	if (!HasPath())
+	{
+		return PathCells;
+	}
+
+	const FMazeFileHeader& Header = GetHeader();
+	PathCells.Init(false, Header.SizeX * Header.SizeY);
+	FMemory::Memcpy(PathCells.GetData(), Data + Header.PathOffset,
+	                GetPathWordsAmount(Header.SizeX, Header.SizeY) * sizeof(uint32));
+	// Bits past the last cell must stay zero, whatever the file contains.
+	if (const int32 UsedBits = PathCells.Num() % 32)
+	{
+		PathCells.GetData()[PathCells.Num() / 32] &= (1u << UsedBits) - 1;
+	}
+	return PathCells;
+}
+
+TArrayView<const int32> FMazeFileReader::GetDistances() const
+{
+	if (!HasDistances())
+	{
+		return TArrayView<const int32>();
+	}
+	return TArrayView<const int32>(reinterpret_cast<const int32*>(Data + GetHeader().DistancesOffset),
+	                               GetDirectionsCellsAmount());
+}
+
+TArrayView<const uint8> FMazeFileReader::GetDirections() const
+{
+	if (!HasDistances())
+	{
+		return TArrayView<const uint8>();
+	}
+	return TArrayView<const uint8>(Data + GetHeader().DirectionsOffset, GetDirectionsCellsAmount());
+}
+
+bool FMazeFileReader::IsContentValid() const
+{
+	const FMazeFileHeader& Header = GetHeader();
+	const int32 Width = (Header.SizeX + 1) / 2;
+	const int32 Height = (Header.SizeY + 1) / 2;
+	const TArrayView<const uint64> Words = GetPassageWords();
+	auto GetBit = [&Words](const int32 Bit) { return Words[Bit >> 6] >> (Bit & 63) & 1; };
+
+	// Bits past the last cell must be zero, otherwise passages are miscounted.
+	if (const int32 UsedBits = Width * Height * 2 % 64)
+	{
+		if (Words.Last() >> UsedBits)
+		{
+			return false;
+		}
+	}
+
+	// Passages must not lead out of the maze: no East passage on the last column and no South one on the last row.
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		if (GetBit((Y * Width + Width - 1) * 2))
+		{
+			return false;
+		}
+	}
+	for (int32 X = 0; X < Width; ++X)
+	{
+		if (GetBit(((Height - 1) * Width + X) * 2 + 1))
+		{
+			return false;
+		}
+	}
+
+	// Every flow field direction is either none or an open passage, so following directions stays within the maze.
+	if (HasDistances())
+	{
+		const TArrayView<const uint8> Directions = GetDirections();
+		for (int32 Node = 0; Node < Directions.Num(); ++Node)
+		{
+			const int32 X = Node % Width;
+			const int32 Y = Node / Width;
+			bool bOpen;
+			switch (static_cast<EDirection>(Directions[Node]))
+			{
+			case EDirection::None:
+				bOpen = true;
+				break;
+			case EDirection::East:
+				bOpen = GetBit(Node * 2);
+				break;
+			case EDirection::South:
+				bOpen = GetBit(Node * 2 + 1);
+				break;
+			case EDirection::West:
+				bOpen = X > 0 && GetBit((Node - 1) * 2);
+				break;
+			case EDirection::North:
+				bOpen = Y > 0 && GetBit((Node - Width) * 2 + 1);
+				break;
+			default:
+				bOpen = false;
+			}
+			if (!bOpen)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int32 FMazeFileReader::GetDirectionsCellsAmount() const
+{
+	return (GetHeader().SizeX + 1) / 2 * ((GetHeader().SizeY + 1) / 2);
+}
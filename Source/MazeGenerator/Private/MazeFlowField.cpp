@@ -0,0 +1,269 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeFlowField.h"
+
+#include "Algorithms/Algorithm.h"
+#include "Async/ParallelFor.h"
+#include "MazeStats.h"
+
+namespace
+{
+	// Smaller wavefronts are expanded serially.
+	constexpr int32 ParallelFrontierThreshold = 4096;
+
+	constexpr int32 FrontierBatchSize = 1024;
+}
+
+void FMazeFlowField::Build(const FMazePassages& InPassages, TArrayView<const FIntPoint> Goals, const bool bParallel)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeBuildFlowField);
+
+	Passages = InPassages;
+	const int32 NodesAmount = Passages.GetWidth() * Passages.GetHeight();
+	Distances.Init(INDEX_NONE, NodesAmount);
+	Directions.Init(static_cast<uint8>(EDirection::None), NodesAmount);
+	Order.Reset();
+	Order.Reserve(NodesAmount);
+
+	// Goals on cells start the wavefront at even distances, goals on passages reach both of their cells in 1 step.
+	TArray<int32> Current;
+	TArray<int32> Pending;
+	for (const FIntPoint& Goal : Goals)
+	{
+		if (Passages.IsFloor(Goal.X, Goal.Y) && !(Goal.X & 1) && !(Goal.Y & 1))
+		{
+			const int32 Node = Passages.ToIndex(Goal.X / 2, Goal.Y / 2);
+			if (Distances[Node] == INDEX_NONE)
+			{
+				Distances[Node] = 0;
+				Current.Add(Node);
+			}
+		}
+	}
+	for (const FIntPoint& Goal : Goals)
+	{
+		if (Passages.IsFloor(Goal.X, Goal.Y) && (Goal.X & 1 || Goal.Y & 1))
+		{
+			int32 First;
+			int32 Second;
+			GetPassageCells(Goal, First, Second);
+			const EDirection FirstToSecond = Goal.X & 1 ? EDirection::East : EDirection::South;
+			for (const int32 Node : {First, Second})
+			{
+				if (Distances[Node] == INDEX_NONE)
+				{
+					Distances[Node] = 1;
+					Directions[Node] = static_cast<uint8>(Node == First ? FirstToSecond : OppositeDirection(FirstToSecond));
+					Pending.Add(Node);
+				}
+			}
+		}
+	}
+
+	TArray<int32> Next;
+	for (int32 Distance = 0; !Current.IsEmpty() || !Pending.IsEmpty(); ++Distance)
+	{
+		Order.Append(Current);
+		Next.Reset();
+		ExpandLevel(Current, Distance, bParallel, Next);
+		Swap(Current, Pending);
+		Swap(Pending, Next);
+	}
+
+	bIncremental = Goals.Num() == 1 && NodesAmount > 0 && Order.Num() == NodesAmount && Distances[Order[0]] == 0
+		&& Passages.CountPassages() == NodesAmount - 1;
+	GoalNode = bIncremental ? Order[0] : INDEX_NONE;
+}
+
+void FMazeFlowField::MoveGoal(const FIntPoint& Goal, const int32 MaxIncrementalDistance, const bool bParallel)
+{
+	const bool bOnCell = !(Goal.X & 1) && !(Goal.Y & 1) && Passages.IsFloor(Goal.X, Goal.Y);
+	const int32 NewGoalNode = bOnCell ? Passages.ToIndex(Goal.X / 2, Goal.Y / 2) : INDEX_NONE;
+	if (!bIncremental || NewGoalNode == INDEX_NONE || Distances[NewGoalNode] > MaxIncrementalDistance)
+	{
+		const FMazePassages CurrentPassages = MoveTemp(Passages);
+		Build(CurrentPassages, MakeArrayView(&Goal, 1), bParallel);
+		return;
+	}
+	if (NewGoalNode == GoalNode)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_MazeBuildFlowField);
+
+	const int32 Width = Passages.GetWidth();
+	auto GetNext = [this, Width](const int32 Node)
+	{
+		const EDirection Direction = static_cast<EDirection>(Directions[Node]);
+		return Node + DirectionDX(Direction) + DirectionDY(Direction) * Width;
+	};
+
+	// Path from the new goal to the old one gets reversed directions, the rest of cells keep theirs.
+	TArray<int32> Path;
+	for (int32 Node = NewGoalNode; Node != GoalNode; Node = GetNext(Node))
+	{
+		Path.Add(Node);
+	}
+	Path.Add(GoalNode);
+
+	for (int32 Index = Path.Num() - 1; Index > 0; --Index)
+	{
+		Directions[Path[Index]] = static_cast<uint8>(OppositeDirection(static_cast<EDirection>(Directions[Path[Index - 1]])));
+	}
+	Directions[NewGoalNode] = static_cast<uint8>(EDirection::None);
+
+	// Path goes first in the new order, every other cell is still ordered after the cell it leads to.
+	TBitArray<> OnPath(false, Distances.Num());
+	TArray<int32> NewOrder;
+	NewOrder.Reserve(Order.Num());
+	for (int32 Index = 0; Index < Path.Num(); ++Index)
+	{
+		OnPath[Path[Index]] = true;
+		Distances[Path[Index]] = Index * 2;
+		NewOrder.Add(Path[Index]);
+	}
+	for (const int32 Node : Order)
+	{
+		if (!OnPath[Node])
+		{
+			Distances[Node] = Distances[GetNext(Node)] + 2;
+			NewOrder.Add(Node);
+		}
+	}
+	Order = MoveTemp(NewOrder);
+	GoalNode = NewGoalNode;
+}
+
+void FMazeFlowField::Assign(const FMazePassages& InPassages, TArrayView<const int32> InDistances,
+                            TArrayView<const uint8> InDirections)
+{
+	check(InDistances.Num() == InPassages.GetWidth() * InPassages.GetHeight());
+	check(InDirections.Num() == InDistances.Num());
+
+	Passages = InPassages;
+	Distances = InDistances;
+	Directions = InDirections;
+	Order.Empty();
+	bIncremental = false;
+	GoalNode = INDEX_NONE;
+}
+
+int32 FMazeFlowField::GetDistance(const FIntPoint& Cell) const
+{
+	if (!Passages.IsFloor(Cell.X, Cell.Y))
+	{
+		return INDEX_NONE;
+	}
+	if (!(Cell.X & 1) && !(Cell.Y & 1))
+	{
+		return Distances[Passages.ToIndex(Cell.X / 2, Cell.Y / 2)];
+	}
+
+	int32 First;
+	int32 Second;
+	GetPassageCells(Cell, First, Second);
+	if (Distances[First] == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+	// Cells of a goal passage lead to each other through it.
+	const EDirection FirstToSecond = Cell.X & 1 ? EDirection::East : EDirection::South;
+	if (Directions[First] == static_cast<uint8>(FirstToSecond)
+		&& Directions[Second] == static_cast<uint8>(OppositeDirection(FirstToSecond)))
+	{
+		return 0;
+	}
+	return FMath::Min(Distances[First], Distances[Second]) + 1;
+}
+
+FIntPoint FMazeFlowField::GetNextStep(const FIntPoint& Cell) const
+{
+	if (!Passages.IsFloor(Cell.X, Cell.Y))
+	{
+		return FIntPoint::ZeroValue;
+	}
+	if (!(Cell.X & 1) && !(Cell.Y & 1))
+	{
+		const EDirection Direction = static_cast<EDirection>(Directions[Passages.ToIndex(Cell.X / 2, Cell.Y / 2)]);
+		return FIntPoint(DirectionDX(Direction), DirectionDY(Direction));
+	}
+
+	int32 First;
+	int32 Second;
+	GetPassageCells(Cell, First, Second);
+	if (Distances[First] == INDEX_NONE || GetDistance(Cell) == 0)
+	{
+		return FIntPoint::ZeroValue;
+	}
+	// Passage between areas of different goals is left towards either cell, both are equally far.
+	const int32 Sign = Distances[First] <= Distances[Second] ? -1 : 1;
+	return Cell.X & 1 ? FIntPoint(Sign, 0) : FIntPoint(0, Sign);
+}
+
+SIZE_T FMazeFlowField::GetAllocatedSize() const
+{
+	return Passages.GetAllocatedSize() + Distances.GetAllocatedSize() + Directions.GetAllocatedSize()
+		+ Order.GetAllocatedSize();
+}
+
+void FMazeFlowField::Empty()
+{
+	Passages.Empty();
+	Distances.Empty();
+	Directions.Empty();
+	Order.Empty();
+	bIncremental = false;
+	GoalNode = INDEX_NONE;
+}
+
+void FMazeFlowField::ExpandLevel(const TArray<int32>& Frontier, const int32 Distance, const bool bParallel,
+                                 TArray<int32>& OutNext)
+{
+	// Cells are claimed atomically, so each cell is added once even if several threads reach it.
+	auto Expand = [this, Distance](const int32 Node, TArray<int32>& Next)
+	{
+		ForEachPassage(Passages, Node, [this, Distance, &Next](const int32 NextNode, const EDirection Back)
+		{
+			if (Distances[NextNode] == INDEX_NONE
+				&& FPlatformAtomics::InterlockedCompareExchange(&Distances[NextNode], Distance + 2, INDEX_NONE)
+				== INDEX_NONE)
+			{
+				Directions[NextNode] = static_cast<uint8>(Back);
+				Next.Add(NextNode);
+			}
+		});
+	};
+
+	if (!bParallel || Frontier.Num() < ParallelFrontierThreshold)
+	{
+		for (const int32 Node : Frontier)
+		{
+			Expand(Node, OutNext);
+		}
+		return;
+	}
+
+	const int32 BatchesAmount = FMath::DivideAndRoundUp(Frontier.Num(), FrontierBatchSize);
+	TArray<TArray<int32>> BatchesNext;
+	BatchesNext.SetNum(BatchesAmount);
+	ParallelFor(BatchesAmount, [&Frontier, &BatchesNext, &Expand](const int32 Batch)
+	{
+		const int32 End = FMath::Min((Batch + 1) * FrontierBatchSize, Frontier.Num());
+		for (int32 Index = Batch * FrontierBatchSize; Index < End; ++Index)
+		{
+			Expand(Frontier[Index], BatchesNext[Batch]);
+		}
+	});
+	for (const TArray<int32>& BatchNext : BatchesNext)
+	{
+		OutNext.Append(BatchNext);
+	}
+}
+
+void FMazeFlowField::GetPassageCells(const FIntPoint& Cell, int32& OutFirst, int32& OutSecond) const
+{
+	OutFirst = Passages.ToIndex(Cell.X / 2, Cell.Y / 2);
+	OutSecond = Cell.X & 1 ? OutFirst + 1 : OutFirst + Passages.GetWidth();
+}
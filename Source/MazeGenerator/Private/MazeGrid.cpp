@@ -0,0 +1,44 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeGrid.h"
+
+FMazeGrid::FMazeGrid(): Width(0), Height(0), Stride(0)
+{
+}
+
+FMazeGrid::FMazeGrid(const int32 InWidth, const int32 InHeight): Width(InWidth), Height(InHeight), Stride(InWidth)
+{
+	check(Width >= 0 && Height >= 0);
+	Cells.SetNumZeroed(Stride * Height);
+}
+
+FMazeGrid::FMazeGrid(const FIntVector2& Size): FMazeGrid(Size.X, Size.Y)
+{
+}
+
+SIZE_T FMazeGrid::GetAllocatedSize() const
+{
+	return Cells.GetAllocatedSize();
+}
+
+void FMazeGrid::Empty()
+{
+	Width = Height = Stride = 0;
+	Cells.Empty();
+}
+
+int32 UMazeGridLibrary::GetGridWidth(const FMazeGrid& Grid)
+{
+	return Grid.GetWidth();
+}
+
+int32 UMazeGridLibrary::GetGridHeight(const FMazeGrid& Grid)
+{
+	return Grid.GetHeight();
+}
+
+uint8 UMazeGridLibrary::GetGridCell(const FMazeGrid& Grid, const int32 X, const int32 Y)
+{
+	return Grid.IsValidIndex(X, Y) ? Grid(X, Y) : 0;
+}
@@ -0,0 +1,72 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazePassages.h"
+
+#include "MazeStats.h"
+
+FMazePassages::FMazePassages(): Width(0), Height(0), MazeSize(0, 0)
+{
+}
+
+FMazePassages::FMazePassages(const FIntVector2& InMazeSize)
+	: Width((InMazeSize.X + 1) / 2), Height((InMazeSize.Y + 1) / 2), MazeSize(InMazeSize)
+{
+	const int64 BitsAmount = static_cast<int64>(Width) * Height * 2;
+	Words.SetNumZeroed((BitsAmount + 63) / 64);
+}
+
+FMazePassages::FMazePassages(const FIntVector2& InMazeSize, TArrayView<const uint64> InWords)
+	: Width((InMazeSize.X + 1) / 2), Height((InMazeSize.Y + 1) / 2), MazeSize(InMazeSize),
+	  Words(InWords.GetData(), InWords.Num())
+{
+	check(Words.Num() == (static_cast<int64>(Width) * Height * 2 + 63) / 64);
+}
+
+FMazeGrid FMazePassages::ToGrid() const
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeExpandGrid);
+
+	FMazeGrid Grid(MazeSize);
+
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			Grid(X * 2, Y * 2) = 1;
+
+			if (HasEast(X, Y))
+			{
+				Grid(X * 2 + 1, Y * 2) = 1;
+			}
+			if (HasSouth(X, Y))
+			{
+				Grid(X * 2, Y * 2 + 1) = 1;
+			}
+		}
+	}
+
+	return Grid;
+}
+
+int32 FMazePassages::CountPassages() const
+{
+	int32 Amount = 0;
+	for (const uint64 Word : Words)
+	{
+		Amount += FMath::CountBits(Word);
+	}
+	return Amount;
+}
+
+SIZE_T FMazePassages::GetAllocatedSize() const
+{
+	return Words.GetAllocatedSize();
+}
+
+void FMazePassages::Empty()
+{
+	Width = Height = 0;
+	MazeSize = FIntVector2(0, 0);
+	Words.Empty();
+}
@@ -0,0 +1,246 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazePathTree.h"
+
+#include "Algo/Reverse.h"
+#include "Algorithms/Algorithm.h"
+#include "MazeStats.h"
+
+FMazePathTree::FMazePathTree(const FMazePassages& Passages)
+	: MazeSize(Passages.GetMazeSize()), Width(Passages.GetWidth())
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeBuildPathTree);
+
+	const int32 NodesAmount = Passages.GetWidth() * Passages.GetHeight();
+	Parents.SetNumZeroed(NodesAmount);
+	Depths.SetNumUninitialized(NodesAmount);
+	Heads.SetNumUninitialized(NodesAmount);
+
+	// Breadth-first order puts every parent before its children.
+	TArray<int32> Order;
+	Order.Reserve(NodesAmount);
+	TBitArray<> Visited(false, NodesAmount);
+	for (int32 Root = 0; Root < NodesAmount; ++Root)
+	{
+		if (Visited[Root])
+		{
+			continue;
+		}
+		Visited[Root] = true;
+		Depths[Root] = 0;
+		for (int32 Head = Order.Add(Root); Head < Order.Num(); ++Head)
+		{
+			const int32 Node = Order[Head];
+			ForEachPassage(Passages, Node, [this, &Order, &Visited, Node](const int32 NextNode, const EDirection Back)
+			{
+				if (!Visited[NextNode])
+				{
+					Visited[NextNode] = true;
+					Parents[NextNode] = static_cast<uint8>(Back);
+					Depths[NextNode] = Depths[Node] + 1;
+					Order.Add(NextNode);
+				}
+			});
+		}
+	}
+
+	// Subtree sizes are accumulated children first, the largest child continues heavy path of its parent.
+	TArray<int32> Sizes;
+	Sizes.Init(1, NodesAmount);
+	TArray<int32> HeavyChildren;
+	HeavyChildren.Init(INDEX_NONE, NodesAmount);
+	for (int32 Index = Order.Num() - 1; Index >= 0; --Index)
+	{
+		const int32 Node = Order[Index];
+		const int32 Parent = GetParent(Node);
+		if (Parent != INDEX_NONE)
+		{
+			Sizes[Parent] += Sizes[Node];
+			if (HeavyChildren[Parent] == INDEX_NONE || Sizes[Node] > Sizes[HeavyChildren[Parent]])
+			{
+				HeavyChildren[Parent] = Node;
+			}
+		}
+	}
+
+	for (const int32 Node : Order)
+	{
+		const int32 Parent = GetParent(Node);
+		Heads[Node] = Parent != INDEX_NONE && HeavyChildren[Parent] == Node ? Heads[Parent] : Node;
+	}
+}
+
+int32 FMazePathTree::GetPathLength(const FIntPoint& Start, const FIntPoint& End) const
+{
+	int32 StartNode;
+	int32 EndNode;
+	const int32 Steps = FindClosestAnchors(Start, End, StartNode, EndNode);
+	return Steps == INDEX_NONE ? INDEX_NONE : Steps + 1;
+}
+
+bool FMazePathTree::GetPath(const FIntPoint& Start, const FIntPoint& End, TArray<FIntPoint>& OutPath) const
+{
+	OutPath.Reset();
+
+	int32 StartNode;
+	int32 EndNode;
+	const int32 Steps = FindClosestAnchors(Start, End, StartNode, EndNode);
+	if (Steps == INDEX_NONE)
+	{
+		return false;
+	}
+	OutPath.Reserve(Steps + 1);
+	if (Start == End)
+	{
+		OutPath.Add(Start);
+		return true;
+	}
+
+	const int32 Ancestor = FindAncestor(StartNode, EndNode);
+	auto ToCell = [this](const int32 Node) { return FIntPoint(Node % Width * 2, Node / Width * 2); };
+
+	// Walks from node up to the ancestor, adding passages and cells(except the ancestor itself).
+	auto Climb = [this, &OutPath, &ToCell, Ancestor](int32 Node)
+	{
+		while (Node != Ancestor)
+		{
+			const int32 Parent = GetParent(Node);
+			OutPath.Add(ToCell(Node));
+			OutPath.Add((ToCell(Node) + ToCell(Parent)) / 2);
+			Node = Parent;
+		}
+	};
+
+	if (ToCell(StartNode) != Start)
+	{
+		OutPath.Add(Start);
+	}
+	Climb(StartNode);
+	OutPath.Add(ToCell(Ancestor));
+
+	const int32 TurnIndex = OutPath.Num();
+	if (ToCell(EndNode) != End)
+	{
+		OutPath.Add(End);
+	}
+	Climb(EndNode);
+	Algo::Reverse(OutPath.GetData() + TurnIndex, OutPath.Num() - TurnIndex);
+
+	return true;
+}
+
+SIZE_T FMazePathTree::GetAllocatedSize() const
+{
+	return Parents.GetAllocatedSize() + Depths.GetAllocatedSize() + Heads.GetAllocatedSize();
+}
+
+void FMazePathTree::Empty()
+{
+	MazeSize = FIntVector2(0, 0);
+	Width = 0;
+	Parents.Empty();
+	Depths.Empty();
+	Heads.Empty();
+}
+
+int32 FMazePathTree::GetAnchors(const FIntPoint& Point, FAnchor (&OutAnchors)[2]) const
+{
+	if (Point.X < 0 || Point.Y < 0 || Point.X >= MazeSize.X || Point.Y >= MazeSize.Y)
+	{
+		return 0;
+	}
+
+	const int32 Node = Point.Y / 2 * Width + Point.X / 2;
+	const bool bOddX = Point.X & 1;
+	const bool bOddY = Point.Y & 1;
+	if (!bOddX && !bOddY)
+	{
+		OutAnchors[0] = {Node, 0};
+		return 1;
+	}
+	if (bOddX && bOddY)
+	{
+		return 0;
+	}
+
+	// Passage is open only if one of the cells it connects is the parent of the other.
+	const int32 OppositeNode = bOddX ? Node + 1 : Node + Width;
+	if (GetParent(Node) != OppositeNode && GetParent(OppositeNode) != Node)
+	{
+		return 0;
+	}
+	OutAnchors[0] = {Node, 1};
+	OutAnchors[1] = {OppositeNode, 1};
+	return 2;
+}
+
+int32 FMazePathTree::FindClosestAnchors(const FIntPoint& Start, const FIntPoint& End, int32& OutStartNode,
+                                        int32& OutEndNode) const
+{
+	FAnchor StartAnchors[2];
+	FAnchor EndAnchors[2];
+	const int32 StartAnchorsAmount = GetAnchors(Start, StartAnchors);
+	const int32 EndAnchorsAmount = GetAnchors(End, EndAnchors);
+	if (!StartAnchorsAmount || !EndAnchorsAmount)
+	{
+		return INDEX_NONE;
+	}
+
+	OutStartNode = StartAnchors[0].Node;
+	OutEndNode = EndAnchors[0].Node;
+	if (Start == End)
+	{
+		return 0;
+	}
+
+	int32 MinSteps = INDEX_NONE;
+	for (int32 StartIndex = 0; StartIndex < StartAnchorsAmount; ++StartIndex)
+	{
+		for (int32 EndIndex = 0; EndIndex < EndAnchorsAmount; ++EndIndex)
+		{
+			const FAnchor& StartAnchor = StartAnchors[StartIndex];
+			const FAnchor& EndAnchor = EndAnchors[EndIndex];
+			const int32 Ancestor = FindAncestor(StartAnchor.Node, EndAnchor.Node);
+			if (Ancestor == INDEX_NONE)
+			{
+				return INDEX_NONE;
+			}
+
+			const int32 Steps = StartAnchor.Steps + EndAnchor.Steps
+				+ (Depths[StartAnchor.Node] + Depths[EndAnchor.Node] - Depths[Ancestor] * 2) * 2;
+			if (MinSteps == INDEX_NONE || Steps < MinSteps)
+			{
+				MinSteps = Steps;
+				OutStartNode = StartAnchor.Node;
+				OutEndNode = EndAnchor.Node;
+			}
+		}
+	}
+	return MinSteps;
+}
+
+int32 FMazePathTree::FindAncestor(int32 First, int32 Second) const
+{
+	while (Heads[First] != Heads[Second])
+	{
+		if (Depths[Heads[First]] < Depths[Heads[Second]])
+		{
+			Swap(First, Second);
+		}
+		// Heads of both paths are roots of different trees.
+		const int32 Parent = GetParent(Heads[First]);
+		if (Parent == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+		First = Parent;
+	}
+	return Depths[First] < Depths[Second] ? First : Second;
+}
+
+int32 FMazePathTree::GetParent(const int32 Node) const
+{
+	const EDirection Direction = static_cast<EDirection>(Parents[Node]);
+	return Direction == EDirection::None ? INDEX_NONE : Node + DirectionDX(Direction) + DirectionDY(Direction) * Width;
+}
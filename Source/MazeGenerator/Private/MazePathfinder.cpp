@@ -0,0 +1,294 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazePathfinder.h"
+
+#include "Algo/Reverse.h"
+#include "Algorithms/Algorithm.h"
+#include "MazeStats.h"
+
+bool FMazePathfinder::FindPath(const FMazePassages& Passages, const FIntPoint& Start, const FIntPoint& End,
+                               const EMazePathfindingMode Mode, TBitArray<>& OutPathCells, int32& OutLength)
+{
+	SCOPE_CYCLE_COUNTER(STAT_MazeFindPath);
+
+	OutPathCells.Empty();
+	OutLength = 0;
+
+	if (!Passages.IsFloor(Start.X, Start.Y) || !Passages.IsFloor(End.X, End.Y))
+	{
+		return false;
+	}
+
+	const FIntVector2 Size = Passages.GetMazeSize();
+	OutPathCells.Init(false, Size.X * Size.Y);
+
+	auto MarkCell = [&OutPathCells, &OutLength, &Size](const int32 X, const int32 Y, const bool bValue)
+	{
+		OutPathCells[Y * Size.X + X] = bValue;
+		OutLength += bValue ? 1 : -1;
+	};
+
+	if (Start == End)
+	{
+		MarkCell(Start.X, Start.Y, true);
+		return true;
+	}
+
+	// Start and end are snapped to directions grid cells. If any of them lies on a passage,
+	// then the snapped cell is the western or the northern one, which is fixed up after the search.
+	const int32 Width = Passages.GetWidth();
+	const int32 StartNode = Passages.ToIndex(Start.X / 2, Start.Y / 2);
+	const int32 EndNode = Passages.ToIndex(End.X / 2, End.Y / 2);
+
+	NodePath.Reset();
+	bool bFound;
+	switch (Mode)
+	{
+	case EMazePathfindingMode::BidirectionalBFS:
+		bFound = SearchBidirectionalBFS(Passages, StartNode, EndNode);
+		break;
+	case EMazePathfindingMode::AStar:
+		bFound = SearchAStar(Passages, StartNode, EndNode);
+		break;
+	default:
+		bFound = SearchBFS(Passages, StartNode, EndNode);
+	}
+
+	if (!bFound)
+	{
+		OutPathCells.Empty();
+		OutLength = 0;
+		return false;
+	}
+
+	for (int32 Index = 0; Index < NodePath.Num(); ++Index)
+	{
+		const int32 X = NodePath[Index] % Width;
+		const int32 Y = NodePath[Index] / Width;
+		MarkCell(X * 2, Y * 2, true);
+		if (Index > 0)
+		{
+			// Passage lies between two cells.
+			MarkCell(X + NodePath[Index - 1] % Width, Y + NodePath[Index - 1] / Width, true);
+		}
+	}
+
+	// Passage endpoints: either the path already goes through the passage
+	// and the snapped cell behind it has to be dropped, or the passage itself has to be appended.
+	auto FixPassageEndpoint = [&](const FIntPoint& Point, const int32 SnappedNode, const int32 NextNode)
+	{
+		if (!(Point.X & 1) && !(Point.Y & 1))
+		{
+			return;
+		}
+		const int32 OppositeNode = Point.X & 1 ? SnappedNode + 1 : SnappedNode + Width;
+		if (NextNode == OppositeNode)
+		{
+			MarkCell(Point.X / 2 * 2, Point.Y / 2 * 2, false);
+		}
+		else
+		{
+			MarkCell(Point.X, Point.Y, true);
+		}
+	};
+
+	const bool bSingleNode = NodePath.Num() == 1;
+	FixPassageEndpoint(End, EndNode, bSingleNode ? INDEX_NONE : NodePath[NodePath.Num() - 2]);
+	FixPassageEndpoint(Start, StartNode, bSingleNode ? INDEX_NONE : NodePath[1]);
+
+	return true;
+}
+
+SIZE_T FMazePathfinder::GetAllocatedSize() const
+{
+	return Marks.GetAllocatedSize() + Parents.GetAllocatedSize() + Costs.GetAllocatedSize()
+		+ Queue.GetAllocatedSize() + BackwardQueue.GetAllocatedSize() + OpenNodes.GetAllocatedSize()
+		+ NodePath.GetAllocatedSize();
+}
+
+void FMazePathfinder::Empty()
+{
+	Marks.Empty();
+	Mark = 0;
+	Parents.Empty();
+	Costs.Empty();
+	Queue.Empty();
+	BackwardQueue.Empty();
+	OpenNodes.Empty();
+	NodePath.Empty();
+}
+
+uint32 FMazePathfinder::BeginSearch(const int32 NodesAmount)
+{
+	if (Marks.Num() != NodesAmount || Mark >= MAX_uint32 - 2)
+	{
+		Marks.Reset();
+		Marks.SetNumZeroed(NodesAmount);
+		Parents.SetNumUninitialized(NodesAmount);
+		Mark = 0;
+	}
+	Mark += 2;
+	return Mark;
+}
+
+bool FMazePathfinder::SearchBFS(const FMazePassages& Passages, const int32 StartNode, const int32 EndNode)
+{
+	const uint32 Visited = BeginSearch(Passages.GetWidth() * Passages.GetHeight());
+
+	Marks[StartNode] = Visited;
+	Queue.Reset();
+	Queue.Add(StartNode);
+	for (int32 Head = 0; Head < Queue.Num() && Marks[EndNode] != Visited; ++Head)
+	{
+		ForEachPassage(Passages, Queue[Head], [this, Visited](const int32 NextNode, const EDirection ToParent)
+		{
+			if (Marks[NextNode] != Visited)
+			{
+				Marks[NextNode] = Visited;
+				Parents[NextNode] = static_cast<uint8>(ToParent);
+				Queue.Add(NextNode);
+			}
+		});
+	}
+
+	if (Marks[EndNode] != Visited)
+	{
+		return false;
+	}
+
+	AppendChain(Passages, EndNode, StartNode);
+	Algo::Reverse(NodePath);
+	return true;
+}
+
+bool FMazePathfinder::SearchBidirectionalBFS(const FMazePassages& Passages, const int32 StartNode,
+                                             const int32 EndNode)
+{
+	const uint32 ForwardVisited = BeginSearch(Passages.GetWidth() * Passages.GetHeight());
+	const uint32 BackwardVisited = ForwardVisited + 1;
+
+	if (StartNode == EndNode)
+	{
+		NodePath.Add(StartNode);
+		return true;
+	}
+
+	Marks[StartNode] = ForwardVisited;
+	Marks[EndNode] = BackwardVisited;
+	Queue.Reset();
+	Queue.Add(StartNode);
+	BackwardQueue.Reset();
+	BackwardQueue.Add(EndNode);
+
+	int32 ForwardHead = 0;
+	int32 BackwardHead = 0;
+	// Adjacent nodes where searches met, visited by forward and backward search respectively.
+	int32 MeetForward = INDEX_NONE;
+	int32 MeetBackward = INDEX_NONE;
+	while (MeetForward == INDEX_NONE && ForwardHead < Queue.Num() && BackwardHead < BackwardQueue.Num())
+	{
+		// Whole level of the smaller frontier is expanded, so searches stay balanced.
+		const bool bForward = Queue.Num() - ForwardHead <= BackwardQueue.Num() - BackwardHead;
+		TArray<int32>& Frontier = bForward ? Queue : BackwardQueue;
+		int32& Head = bForward ? ForwardHead : BackwardHead;
+		const uint32 Own = bForward ? ForwardVisited : BackwardVisited;
+		const uint32 Other = bForward ? BackwardVisited : ForwardVisited;
+
+		for (const int32 LevelEnd = Frontier.Num(); Head < LevelEnd && MeetForward == INDEX_NONE; ++Head)
+		{
+			const int32 Node = Frontier[Head];
+			ForEachPassage(Passages, Node, [&](const int32 NextNode, const EDirection ToParent)
+			{
+				if (MeetForward != INDEX_NONE || Marks[NextNode] == Own)
+				{
+					return;
+				}
+				if (Marks[NextNode] == Other)
+				{
+					MeetForward = bForward ? Node : NextNode;
+					MeetBackward = bForward ? NextNode : Node;
+					return;
+				}
+				Marks[NextNode] = Own;
+				Parents[NextNode] = static_cast<uint8>(ToParent);
+				Frontier.Add(NextNode);
+			});
+		}
+	}
+
+	if (MeetForward == INDEX_NONE)
+	{
+		return false;
+	}
+
+	AppendChain(Passages, MeetForward, StartNode);
+	Algo::Reverse(NodePath);
+	AppendChain(Passages, MeetBackward, EndNode);
+	return true;
+}
+
+bool FMazePathfinder::SearchAStar(const FMazePassages& Passages, const int32 StartNode, const int32 EndNode)
+{
+	const int32 Width = Passages.GetWidth();
+	const int32 NodesAmount = Width * Passages.GetHeight();
+	const uint32 Visited = BeginSearch(NodesAmount);
+	if (Costs.Num() != NodesAmount)
+	{
+		Costs.SetNumUninitialized(NodesAmount);
+	}
+
+	const int32 EndX = EndNode % Width;
+	const int32 EndY = EndNode / Width;
+	auto GetHeuristic = [Width, EndX, EndY](const int32 Node)
+	{
+		return FMath::Abs(Node % Width - EndX) + FMath::Abs(Node / Width - EndY);
+	};
+
+	OpenNodes.Reset();
+	Marks[StartNode] = Visited;
+	Costs[StartNode] = 0;
+	OpenNodes.HeapPush({GetHeuristic(StartNode), 0, StartNode});
+	while (!OpenNodes.IsEmpty())
+	{
+		FOpenNode Current;
+		OpenNodes.HeapPop(Current, EAllowShrinking::No);
+		if (Current.Node == EndNode)
+		{
+			AppendChain(Passages, EndNode, StartNode);
+			Algo::Reverse(NodePath);
+			return true;
+		}
+		// Node has been reached cheaper after it was pushed.
+		if (Current.Cost > Costs[Current.Node])
+		{
+			continue;
+		}
+
+		ForEachPassage(Passages, Current.Node, [&](const int32 NextNode, const EDirection ToParent)
+		{
+			const int32 Cost = Current.Cost + 1;
+			if (Marks[NextNode] == Visited && Costs[NextNode] <= Cost)
+			{
+				return;
+			}
+			Marks[NextNode] = Visited;
+			Costs[NextNode] = Cost;
+			Parents[NextNode] = static_cast<uint8>(ToParent);
+			OpenNodes.HeapPush({Cost + GetHeuristic(NextNode), Cost, NextNode});
+		});
+	}
+	return false;
+}
+
+void FMazePathfinder::AppendChain(const FMazePassages& Passages, int32 Node, const int32 Root)
+{
+	const int32 Width = Passages.GetWidth();
+	NodePath.Add(Node);
+	while (Node != Root)
+	{
+		const EDirection ToParent = static_cast<EDirection>(Parents[Node]);
+		Node += DirectionDX(ToParent) + DirectionDY(ToParent) * Width;
+		NodePath.Add(Node);
+	}
+}
@@ -0,0 +1,23 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "MazeStats.h"
+
+DEFINE_STAT(STAT_MazeUpdate);
+DEFINE_STAT(STAT_MazeGenerateDirections);
+DEFINE_STAT(STAT_MazePackPassages);
+DEFINE_STAT(STAT_MazeExpandGrid);
+DEFINE_STAT(STAT_MazeFindPath);
+DEFINE_STAT(STAT_MazeBuildPathTree);
+DEFINE_STAT(STAT_MazeBuildFlowField);
+DEFINE_STAT(STAT_MazeCreateInstances);
+DEFINE_STAT(STAT_MazeEnableCollision);
+DEFINE_STAT(STAT_MazeLoadBaked);
+
+DEFINE_STAT(STAT_MazePassagesMemory);
+DEFINE_STAT(STAT_MazePathMemory);
+DEFINE_STAT(STAT_MazeFlowFieldMemory);
+DEFINE_STAT(STAT_MazeFloorInstances);
+DEFINE_STAT(STAT_MazeWallInstances);
+DEFINE_STAT(STAT_MazePathInstances);
+DEFINE_STAT(STAT_MazeOutlineInstances);
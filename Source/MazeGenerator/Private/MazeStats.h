@@ -0,0 +1,30 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+
+// Readout: stat Maze
+DECLARE_STATS_GROUP(TEXT("Maze"), STATGROUP_Maze, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Maze"), STAT_MazeUpdate, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Generate Directions Grid"), STAT_MazeGenerateDirections, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pack Passages"), STAT_MazePackPassages, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Expand Grid"), STAT_MazeExpandGrid, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path"), STAT_MazeFindPath, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Path Tree"), STAT_MazeBuildPathTree, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Flow Field"), STAT_MazeBuildFlowField, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Create Instances"), STAT_MazeCreateInstances, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enable Collision"), STAT_MazeEnableCollision, STATGROUP_Maze, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Baked Maze"), STAT_MazeLoadBaked, STATGROUP_Maze, );
+
+// Memory and instance stats are summed over all existing mazes.
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Passages Memory"), STAT_MazePassagesMemory, STATGROUP_Maze, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Path Memory"), STAT_MazePathMemory, STATGROUP_Maze, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Flow Field Memory"), STAT_MazeFlowFieldMemory, STATGROUP_Maze, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Floor Instances"), STAT_MazeFloorInstances, STATGROUP_Maze, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Wall Instances"), STAT_MazeWallInstances, STATGROUP_Maze, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Path Instances"), STAT_MazePathInstances, STATGROUP_Maze, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Outline Instances"), STAT_MazeOutlineInstances, STATGROUP_Maze, );
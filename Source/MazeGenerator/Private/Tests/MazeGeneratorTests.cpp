@@ -0,0 +1,408 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+
+#include "Maze.h"
+#include "Algorithms/Eller.h"
+#include "MazeAlgorithmRegistry.h"
+#include "MazeFile.h"
+#include "MazeFlowField.h"
+#include "MazePathfinder.h"
+#include "MazePathTree.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Expanded grid size, odd so that border cells are not walls.
+	const FIntVector2 TestMazeSize(81, 61);
+
+	FMazePassages GeneratePassages(const FName Key, const FIntVector2& Size, const int32 Seed,
+	                               const FGenerationOptions& Options = FGenerationOptions())
+	{
+		const TSharedPtr<const Algorithm> GenerationAlgorithm = FMazeAlgorithmRegistry::Get().Find(Key);
+		return GenerationAlgorithm ? GenerationAlgorithm->GetPassages(Size, Seed, Options) : FMazePassages();
+	}
+
+	// Passages of a perfect maze form a spanning tree of directions grid cells.
+	bool IsPerfect(const FMazePassages& Passages)
+	{
+		if (Passages.CountPassages() != Passages.GetWidth() * Passages.GetHeight() - 1)
+		{
+			return false;
+		}
+
+		FMazeFlowField FlowField;
+		const FIntPoint Goal(0, 0);
+		FlowField.Build(Passages, MakeArrayView(&Goal, 1), false);
+		return !FlowField.GetDistances().Contains(INDEX_NONE);
+	}
+
+	template <typename ElementType>
+	bool AreEqual(TArrayView<const ElementType> First, TArrayView<const ElementType> Second)
+	{
+		return First.Num() == Second.Num()
+			&& FMemory::Memcmp(First.GetData(), Second.GetData(), First.Num() * sizeof(ElementType)) == 0;
+	}
+
+	// Steps from the closest of Goals to every cell of expanded grid found by BFS, INDEX_NONE for walls.
+	TArray<int32> GetGoalDistances(const FMazePassages& Passages, TArrayView<const FIntPoint> Goals)
+	{
+		const FIntVector2 Size = Passages.GetMazeSize();
+		TArray<int32> Distances;
+		Distances.Init(INDEX_NONE, Size.X * Size.Y);
+		TArray<FIntPoint> Queue;
+		for (const FIntPoint& Goal : Goals)
+		{
+			if (Passages.IsFloor(Goal.X, Goal.Y) && Distances[Goal.Y * Size.X + Goal.X] == INDEX_NONE)
+			{
+				Distances[Goal.Y * Size.X + Goal.X] = 0;
+				Queue.Add(Goal);
+			}
+		}
+		for (int32 Index = 0; Index < Queue.Num(); ++Index)
+		{
+			const FIntPoint Cell = Queue[Index];
+			for (const FIntPoint& Offset : {FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1)})
+			{
+				const FIntPoint Next = Cell + Offset;
+				if (Passages.IsFloor(Next.X, Next.Y) && Distances[Next.Y * Size.X + Next.X] == INDEX_NONE)
+				{
+					Distances[Next.Y * Size.X + Next.X] = Distances[Cell.Y * Size.X + Cell.X] + 1;
+					Queue.Add(Next);
+				}
+			}
+		}
+		return Distances;
+	}
+
+	FString GetTestFilePath()
+	{
+		return FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MazeGeneratorTest.maze"));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazePathfindingTest, "MazeGenerator.Pathfinding",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMazePathfindingTest::RunTest(const FString& Parameters)
+{
+	const FIntPoint Queries[][2] = {
+		{{0, 0}, {TestMazeSize.X - 1, TestMazeSize.Y - 1}},
+		{{TestMazeSize.X - 1, 0}, {0, TestMazeSize.Y - 1}},
+		{{2, 58}, {78, 4}},
+		{{40, 30}, {40, 30}},
+	};
+
+	FMazePathfinder Pathfinder;
+	for (const FName Key : FMazeAlgorithmRegistry::Get().GetKeys())
+	{
+		const FMazePassages Passages = GeneratePassages(Key, TestMazeSize, 42);
+		const FMazePathTree PathTree(Passages);
+
+		for (const auto& Query : Queries)
+		{
+			const FString Context = FString::Printf(TEXT("%s %s -> %s"), *Key.ToString(),
+			                                        *Query[0].ToString(), *Query[1].ToString());
+
+			TBitArray<> ExpectedCells;
+			int32 ExpectedLength = 0;
+			if (!TestTrue(Context + TEXT(": BFS finds path"),
+			              Pathfinder.FindPath(Passages, Query[0], Query[1], EMazePathfindingMode::BFS, ExpectedCells,
+			                                  ExpectedLength)))
+			{
+				continue;
+			}
+
+			for (const EMazePathfindingMode Mode : {EMazePathfindingMode::BidirectionalBFS, EMazePathfindingMode::AStar})
+			{
+				const FString ModeContext = Context + TEXT(" ") + UEnum::GetValueAsString(Mode);
+				TBitArray<> PathCells;
+				int32 PathLength = 0;
+				TestTrue(ModeContext + TEXT(": finds path"),
+				         Pathfinder.FindPath(Passages, Query[0], Query[1], Mode, PathCells, PathLength));
+				TestEqual(ModeContext + TEXT(": length"), PathLength, ExpectedLength);
+				TestTrue(ModeContext + TEXT(": cells"), PathCells == ExpectedCells);
+			}
+
+			TestEqual(Context + TEXT(": path tree length"), PathTree.GetPathLength(Query[0], Query[1]), ExpectedLength);
+
+			TArray<FIntPoint> Path;
+			TestTrue(Context + TEXT(": path tree finds path"), PathTree.GetPath(Query[0], Query[1], Path));
+			TestEqual(Context + TEXT(": path tree cells amount"), Path.Num(), ExpectedLength);
+
+			TBitArray<> TreeCells(false, TestMazeSize.X * TestMazeSize.Y);
+			for (const FIntPoint& Cell : Path)
+			{
+				TreeCells[Cell.Y * TestMazeSize.X + Cell.X] = true;
+			}
+			TestTrue(Context + TEXT(": path tree cells"), TreeCells == ExpectedCells);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeFlowFieldTest, "MazeGenerator.FlowField",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMazeFlowFieldTest::RunTest(const FString& Parameters)
+{
+	const FIntPoint Goals[] = {{0, 0}, {2, 0}, {40, 30}, {TestMazeSize.X - 1, TestMazeSize.Y - 1}, {10, 50}};
+
+	for (const FName Key : FMazeAlgorithmRegistry::Get().GetKeys())
+	{
+		const FMazePassages Passages = GeneratePassages(Key, TestMazeSize, 7);
+
+		FMazeFlowField MovedField;
+		MovedField.Build(Passages, MakeArrayView(&Goals[0], 1), false);
+
+		for (const FIntPoint& Goal : MakeArrayView(Goals).RightChop(1))
+		{
+			const FString Context = FString::Printf(TEXT("%s goal %s"), *Key.ToString(), *Goal.ToString());
+
+			// Any distance is small enough, so the field is always patched in place.
+			MovedField.MoveGoal(Goal, MAX_int32, false);
+
+			FMazeFlowField BuiltField;
+			BuiltField.Build(Passages, MakeArrayView(&Goal, 1), false);
+
+			TestTrue(Context + TEXT(": distances"), AreEqual(MovedField.GetDistances(), BuiltField.GetDistances()));
+			TestTrue(Context + TEXT(": directions"), AreEqual(MovedField.GetDirections(), BuiltField.GetDirections()));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeFlowFieldGoalsTest, "MazeGenerator.FlowFieldGoals",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMazeFlowFieldGoalsTest::RunTest(const FString& Parameters)
+{
+	for (const FName Key : FMazeAlgorithmRegistry::Get().GetKeys())
+	{
+		const FMazePassages Passages = GeneratePassages(Key, TestMazeSize, 9);
+
+		// Two cells, a wall, which is ignored, and an open passage in the middle row away from the other goals.
+		TArray<FIntPoint> Goals = {{0, 0}, {TestMazeSize.X - 1, TestMazeSize.Y - 1}, {1, 1}};
+		for (int32 X = 1; X < TestMazeSize.X; X += 2)
+		{
+			if (Passages.IsFloor(X, 30))
+			{
+				Goals.Emplace(X, 30);
+				break;
+			}
+		}
+
+		FMazeFlowField FlowField;
+		FlowField.Build(Passages, Goals, false);
+		const TArray<int32> Expected = GetGoalDistances(Passages, Goals);
+
+		bool bDistancesMatch = true;
+		bool bStepsLeadToGoals = true;
+		for (int32 Y = 0; Y < TestMazeSize.Y; ++Y)
+		{
+			for (int32 X = 0; X < TestMazeSize.X; ++X)
+			{
+				const FIntPoint Cell(X, Y);
+				const int32 Distance = Expected[Y * TestMazeSize.X + X];
+				bDistancesMatch &= FlowField.GetDistance(Cell) == Distance;
+
+				// Every step gets one cell closer to a goal, goals and walls are not left.
+				const FIntPoint Next = Cell + FlowField.GetNextStep(Cell);
+				bStepsLeadToGoals &= Distance > 0
+					                     ? Passages.IsFloor(Next.X, Next.Y)
+					                     && Expected[Next.Y * TestMazeSize.X + Next.X] == Distance - 1
+					                     : Next == Cell;
+			}
+		}
+		TestTrue(Key.ToString() + TEXT(": distances"), bDistancesMatch);
+		TestTrue(Key.ToString() + TEXT(": next steps"), bStepsLeadToGoals);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeParallelFlowFieldTest, "MazeGenerator.ParallelFlowField",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMazeParallelFlowFieldTest::RunTest(const FString& Parameters)
+{
+	// Directions grid is 5000 cells wide, so the wavefront starting at every cell of the first row
+	// is larger than the one FMazeFlowField expands on a single thread(4096).
+	const FIntVector2 Size(9999, 401);
+	const FName SidewinderName = FMazeAlgorithmRegistry::GetBuiltInName(EGenerationAlgorithm::Sidewinder);
+	const FMazePassages Passages = GeneratePassages(SidewinderName, Size, 13);
+
+	// First row of Sidewinder is a single corridor, so every other cell has a single shortest way
+	// to a goal and directions don't depend on the order threads reach cells in.
+	TArray<FIntPoint> Goals;
+	for (int32 X = 0; X < Size.X; X += 2)
+	{
+		Goals.Emplace(X, 0);
+	}
+
+	FMazeFlowField SerialField;
+	SerialField.Build(Passages, Goals, false);
+
+	FMazeFlowField ParallelField;
+	ParallelField.Build(Passages, Goals, true);
+
+	TestFalse(TEXT("Every cell is reached"), ParallelField.GetDistances().Contains(INDEX_NONE));
+	TestTrue(TEXT("Distances"), AreEqual(ParallelField.GetDistances(), SerialField.GetDistances()));
+	TestTrue(TEXT("Directions"), AreEqual(ParallelField.GetDirections(), SerialField.GetDirections()));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeFileTest, "MazeGenerator.File",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMazeFileTest::RunTest(const FString& Parameters)
+{
+	const FString FilePath = GetTestFilePath();
+	const FName BacktrackerName = FMazeAlgorithmRegistry::GetBuiltInName(EGenerationAlgorithm::Backtracker);
+	const FMazePassages Passages = GeneratePassages(BacktrackerName, TestMazeSize, 3);
+
+	TBitArray<> PathCells;
+	int32 PathLength = 0;
+	FMazePathfinder Pathfinder;
+	Pathfinder.FindPath(Passages, FIntPoint(0, 0), FIntPoint(TestMazeSize.X - 1, TestMazeSize.Y - 1),
+	                    EMazePathfindingMode::BFS, PathCells, PathLength);
+
+	FMazeFlowField FlowField;
+	const FIntPoint Goal(20, 20);
+	FlowField.Build(Passages, MakeArrayView(&Goal, 1), false);
+
+	FMazeFileContent Content;
+	Content.Seed = 3;
+	Content.Algorithm = static_cast<uint8>(EGenerationAlgorithm::Backtracker);
+	Content.bParallelGeneration = true;
+	Content.GenerationTileSize = 32;
+	Content.CellSize = FVector2D(100.f, 50.f);
+	Content.PathCells = &PathCells;
+	Content.PathLength = PathLength;
+	Content.Distances = FlowField.GetDistances();
+	Content.Directions = FlowField.GetDirections();
+
+	if (TestTrue(TEXT("Maze is written"), FMazeFileWriter::Write(FilePath, Passages, Content)))
+	{
+		FMazeFileReader Reader;
+		if (TestTrue(TEXT("Maze is read"), Reader.Open(FilePath)))
+		{
+			const FMazeFileHeader& Header = Reader.GetHeader();
+			TestEqual(TEXT("Size X"), Header.SizeX, TestMazeSize.X);
+			TestEqual(TEXT("Size Y"), Header.SizeY, TestMazeSize.Y);
+			TestEqual(TEXT("Seed"), Header.Seed, Content.Seed);
+			TestEqual(TEXT("Algorithm"), Header.Algorithm, Content.Algorithm);
+			TestTrue(TEXT("Parallel generation"), (Header.Flags & FMazeFileHeader::ParallelGeneration) != 0);
+			TestEqual(TEXT("Generation tile size"), Header.GenerationTileSize, Content.GenerationTileSize);
+			TestEqual(TEXT("Cell size X"), Header.CellSizeX, static_cast<float>(Content.CellSize.X));
+			TestEqual(TEXT("Cell size Y"), Header.CellSizeY, static_cast<float>(Content.CellSize.Y));
+			TestTrue(TEXT("Passages"), Reader.GetPassages().GetWords() == Passages.GetWords());
+			TestTrue(TEXT("Has path"), Reader.HasPath());
+			TestTrue(TEXT("Path cells"), Reader.GetPathCells() == PathCells);
+			TestEqual(TEXT("Path length"), Header.PathLength, PathLength);
+			TestTrue(TEXT("Has distances"), Reader.HasDistances());
+			TestTrue(TEXT("Distances"), AreEqual(Reader.GetDistances(), FlowField.GetDistances()));
+			TestTrue(TEXT("Directions"), AreEqual(Reader.GetDirections(), FlowField.GetDirections()));
+		}
+	}
+
+	// Rows streamed into a file give the same maze as generation into memory.
+	const FName EllerName = FMazeAlgorithmRegistry::GetBuiltInName(EGenerationAlgorithm::Eller);
+	const FMazePassages EllerPassages = GeneratePassages(EllerName, TestMazeSize, 5);
+	FMazeFileRowWriter RowWriter;
+	if (TestTrue(TEXT("Streamed maze is opened"), RowWriter.Open(FilePath, TestMazeSize, FMazeFileContent())))
+	{
+		Eller::GenerateRows(EllerPassages.GetWidth(), EllerPassages.GetHeight(), FRandomStream(5),
+		                    [&RowWriter](const int32 Y, const TArrayView<const uint8> Row)
+		                    {
+			                    RowWriter.WriteRow(Row);
+			                    return true;
+		                    });
+		if (TestTrue(TEXT("Streamed maze is written"), RowWriter.Close()))
+		{
+			FMazeFileReader Reader;
+			if (TestTrue(TEXT("Streamed maze is read"), Reader.Open(FilePath)))
+			{
+				TestTrue(TEXT("Streamed passages"), Reader.GetPassages().GetWords() == EllerPassages.GetWords());
+				TestFalse(TEXT("Streamed maze has no path"), Reader.HasPath());
+			}
+		}
+	}
+
+	// Files whose content leads out of the maze are rejected.
+	TArray<uint8> ValidFile;
+	if (TestTrue(TEXT("Maze is written for corruption"), FMazeFileWriter::Write(FilePath, Passages, Content))
+		&& TestTrue(TEXT("Maze is loaded for corruption"), FFileHelper::LoadFileToArray(ValidFile, *FilePath)))
+	{
+		const FMazeFileHeader Header = *reinterpret_cast<const FMazeFileHeader*>(ValidFile.GetData());
+		const int32 Width = Passages.GetWidth();
+		const int32 Height = Passages.GetHeight();
+		const int32 SlackBit = Width * Height * 2;
+		auto SetPassageBit = [&Header](TArray<uint8>& File, const int32 Bit)
+		{
+			File[Header.PassagesOffset + Bit / 8] |= 1 << Bit % 8;
+		};
+
+		const TPair<const TCHAR*, TFunction<void(TArray<uint8>&)>> Corruptions[] = {
+			{TEXT("slack passage bit"), [&](TArray<uint8>& File) { SetPassageBit(File, SlackBit); }},
+			{TEXT("East on last column"), [&](TArray<uint8>& File) { SetPassageBit(File, (Width - 1) * 2); }},
+			{TEXT("South on last row"), [&](TArray<uint8>& File) { SetPassageBit(File, (Height - 1) * Width * 2 + 1); }},
+			{TEXT("unknown direction"), [&](TArray<uint8>& File) { File[Header.DirectionsOffset] = 3; }},
+		};
+		TestTrue(TEXT("Maze has slack passage bits"), SlackBit % 64 != 0);
+		for (const auto& Corruption : Corruptions)
+		{
+			TArray<uint8> File = ValidFile;
+			Corruption.Value(File);
+			FFileHelper::SaveArrayToFile(File, *FilePath);
+			FMazeFileReader Reader;
+			TestFalse(FString::Printf(TEXT("Maze with %s is rejected"), Corruption.Key), Reader.Open(FilePath));
+		}
+	}
+
+	IFileManager::Get().Delete(*FilePath);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMazeAlgorithmsTest, "MazeGenerator.Algorithms",
+                                 EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FMazeAlgorithmsTest::RunTest(const FString& Parameters)
+{
+	const FIntVector2 Size(1001, 1001);
+
+	FGenerationOptions ParallelOptions;
+	ParallelOptions.bParallel = true;
+
+	FGenerationOptions TiledOptions;
+	TiledOptions.TileSize = 64;
+
+	const TPair<const TCHAR*, FGenerationOptions> Modes[] = {
+		{TEXT("serial"), FGenerationOptions()},
+		{TEXT("parallel"), ParallelOptions},
+		{TEXT("tiled"), TiledOptions},
+	};
+
+	for (const FName Key : FMazeAlgorithmRegistry::Get().GetKeys())
+	{
+		for (const auto& Mode : Modes)
+		{
+			const FString Context = FString::Printf(TEXT("%s %s"), *Key.ToString(), Mode.Key);
+
+			const double StartTime = FPlatformTime::Seconds();
+			const FMazePassages Passages = GeneratePassages(Key, Size, 11, Mode.Value);
+			AddInfo(FString::Printf(TEXT("%s: %.2f ms"), *Context, (FPlatformTime::Seconds() - StartTime) * 1000.0));
+
+			TestTrue(Context + TEXT(": maze is perfect"), IsPerfect(Passages));
+			TestTrue(Context + TEXT(": same maze for the same seed"),
+			         GeneratePassages(Key, Size, 11, Mode.Value).GetWords() == Passages.GetWords());
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,114 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <atomic>
+#include "Math/RandomStream.h"
+#include "MazeGrid.h"
+#include "MazePassages.h"
+
+
+enum class EDirection : uint8
+{
+	None = 0,
+	East = 1,
+	North = 2,
+	South = 4,
+	West = 8,
+};
+
+MAZEGENERATOR_API EDirection OppositeDirection(const EDirection Direction);
+
+MAZEGENERATOR_API int32 DirectionDX(const EDirection Direction);
+MAZEGENERATOR_API int32 DirectionDY(const EDirection Direction);
+
+// Calls Visit(NextNode, DirectionBack) for every directions grid cell connected to Node.
+template <typename FunctorType>
+FORCEINLINE void ForEachPassage(const FMazePassages& Passages, const int32 Node, FunctorType&& Visit)
+{
+	const int32 Width = Passages.GetWidth();
+	const int32 X = Node % Width;
+	const int32 Y = Node / Width;
+
+	if (Passages.HasEast(X, Y))
+	{
+		Visit(Node + 1, EDirection::West);
+	}
+	if (Passages.HasWest(X, Y))
+	{
+		Visit(Node - 1, EDirection::East);
+	}
+	if (Passages.HasSouth(X, Y))
+	{
+		Visit(Node + Width, EDirection::North);
+	}
+	if (Passages.HasNorth(X, Y))
+	{
+		Visit(Node - Width, EDirection::South);
+	}
+}
+
+struct FGenerationOptions
+{
+	/**
+	 * Allows algorithm to split generation between worker threads.
+	 * 
+	 * Mazes generated in parallel differ from serial ones with the same seed,
+	 * but do not depend on amount of cores.
+	 */
+	bool bParallel = false;
+
+	/**
+	 * Size of square tiles in directions grid cells(at least 2), 0 disables tiling.
+	 * 
+	 * Tiles are generated concurrently with their own seeds and then joined into a single perfect maze.
+	 * Result is defined by seed and tile size.
+	 */
+	int32 TileSize = 0;
+
+	// Set from another thread to stop generation early. GetPassages returns empty passages then.
+	const std::atomic<bool>* bCancelled = nullptr;
+};
+
+/**
+ * Base of generation algorithms. Algorithms are stateless: everything a generation needs lives on its stack,
+ * so a single instance is shared by all mazes through FMazeAlgorithmRegistry and may run on several threads at once.
+ */
+class MAZEGENERATOR_API Algorithm
+{
+public:
+	virtual ~Algorithm() = default;
+
+	// Returns bit-packed passages of maze of the given size. Thread-safe.
+	FMazePassages GetPassages(const FIntVector2& Size, const int32 Seed,
+	                          const FGenerationOptions& Options = FGenerationOptions()) const;
+
+	// Returns expanded floor/wall grid: 1 for floor and 0 for wall. Thread-safe.
+	FMazeGrid GetGrid(const FIntVector2& Size, const int32 Seed,
+	                  const FGenerationOptions& Options = FGenerationOptions()) const;
+
+protected:
+	static FMazeGrid CreateZeroedGrid(const FIntVector2& Size);
+
+	// Algorithms check it every row, tile or CancelCheckInterval steps and return whatever they have generated.
+	static FORCEINLINE bool IsCancelled(const std::atomic<bool>* bCancelled)
+	{
+		return bCancelled && bCancelled->load(std::memory_order_relaxed);
+	}
+
+	static constexpr int32 CancelCheckInterval = 4096;
+
+private:
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const = 0;
+
+	// Falls back to serial generation for algorithms that can't be parallelized.
+	virtual FMazeGrid GetDirectionsGridParallel(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                            const std::atomic<bool>* bCancelled) const;
+
+	// Generates tiles in parallel and opens one passage per edge of a random spanning tree of tiles.
+	FMazeGrid GetTiledDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                 const int32 TileSize, const std::atomic<bool>* bCancelled) const;
+};
@@ -0,0 +1,74 @@
+﻿// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Algorithms/Algorithm.h"
+
+
+/**
+ * Generates Eller's maze one row at a time.
+ *
+ * Only the current row, the north passages of the following one and the row sets are kept,
+ * so memory is O(width) and the height doesn't have to be known in advance.
+ */
+class MAZEGENERATOR_API FEllerRowGenerator
+{
+public:
+	FEllerRowGenerator(const int32 InWidth, const FRandomStream& InRandomStream);
+
+	/**
+	 * Generates the next row and returns directions of its cells.
+	 * 
+	 * The last row joins all remaining sets, so nothing can be generated after it.
+	 * Returned view stays valid until the next call.
+	 */
+	TArrayView<const uint8> Next(const bool bIsLastRow);
+
+	// Amount of generated rows.
+	FORCEINLINE int32 GetRowsAmount() const { return RowsAmount; }
+
+	FORCEINLINE bool IsFinished() const { return bIsFinished; }
+
+private:
+	int32 Width;
+
+	FRandomStream RandomStream;
+
+	// Renumbers sets of the current row from 1, so ids are reused instead of wrapping on endless streams.
+	void CompactSets();
+
+	// Set of each cell in the current row, 0 for cells without a set.
+	TArray<uint32> Row;
+
+	uint32 SetsCounter;
+
+	TArray<uint8> CurrentDirections;
+
+	TArray<uint8> NextDirections;
+
+	int32 RowsAmount;
+
+	bool bIsFinished;
+};
+
+class MAZEGENERATOR_API Eller : public Algorithm
+{
+public:
+	virtual ~Eller() override = default;
+
+	/**
+	 * Streams maze directly to the consumer without materializing the grid.
+	 * 
+	 * Consumer receives row index and directions of its cells.
+	 * If Height is INDEX_NONE, rows are generated until the consumer returns false,
+	 * after which one more closing row is emitted. Otherwise, returning false stops generation immediately.
+	 */
+	static void GenerateRows(const int32 Width, const int32 Height, const FRandomStream& RandomStream,
+	                         TFunctionRef<bool(int32, TArrayView<const uint8>)> Consumer);
+
+private:
+	virtual FMazeGrid GetDirectionsGrid(const FIntVector2& Size, const FRandomStream& RandomStream,
+	                                    const std::atomic<bool>* bCancelled) const override;
+};
@@ -3,8 +3,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
 #include "GameFramework/Actor.h"
 
+#include <atomic>
+#include "MazeFlowField.h"
+#include "MazeGrid.h"
+#include "MazePassages.h"
+#include "MazePathfinder.h"
+#include "MazePathTree.h"
+
 #include "Maze.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogMaze, Warning, All);
@@ -18,7 +26,8 @@ enum class EGenerationAlgorithm : uint8
 	Sidewinder,
 	Kruskal,
 	Eller,
-	Prim
+	Prim,
+	BinaryTree UMETA(DisplayName="Binary Tree")
 };
 
 USTRUCT(BlueprintType)
@@ -63,14 +72,136 @@ struct FMazeCoordinates
 	operator TPair<int32, int32>() const;
 };
 
+class AMaze;
 class Algorithm;
+class UMazeDataAsset;
 class UHierarchicalInstancedStaticMeshComponent;
+class ULineBatchComponent;
+
+// Everything needed to generate maze data away from the game thread.
+struct FMazeGenerationRequest
+{
+	TSharedPtr<const Algorithm> GenerationAlgorithm;
+
+	FIntVector2 Size{0, 0};
+
+	int32 Seed = 0;
+
+	bool bParallel = false;
+
+	// In directions grid cells.
+	int32 TileSize = 0;
+
+	bool bGeneratePath = false;
+
+	FMazeCoordinates PathStart;
+
+	FMazeCoordinates PathEnd;
+
+	EMazePathfindingMode PathfindingMode = EMazePathfindingMode::BidirectionalBFS;
+
+	bool bPrecomputePathQueries = false;
+};
+
+struct FMazeGenerationResult
+{
+	FMazePassages Passages;
+
+	TBitArray<> PathCells;
+
+	int32 PathLength = 0;
+
+	// Path flag of the request, the actor's one may have changed while generating.
+	bool bGeneratePath = false;
+
+	// Empty if path queries are not precomputed.
+	FMazePathTree PathTree;
+};
+
+// Components drawing cells of a rectangular region of maze.
+USTRUCT()
+struct FMazeCellsChunk
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	UHierarchicalInstancedStaticMeshComponent* FloorCells = nullptr;
+
+	UPROPERTY(Transient)
+	UHierarchicalInstancedStaticMeshComponent* WallCells = nullptr;
+
+	UPROPERTY(Transient)
+	UHierarchicalInstancedStaticMeshComponent* PathFloorCells = nullptr;
+
+	// First cell of the region.
+	FIntVector2 Origin{0, 0};
+
+	FIntVector2 Size{0, 0};
+
+	/**
+	 * Packed (Y << 16 | X) coordinates of the cell drawn by each instance of per-cell components.
+	 * Used to reuse instances of cells which keep their type when maze is regenerated.
+	 */
+	TArray<uint32> FloorSlots;
+
+	TArray<uint32> WallSlots;
+
+	TArray<uint32> PathSlots;
+};
+
+// One bit per cell of a chunk for every cell type.
+struct FMazeChunkCells
+{
+	TBitArray<> Floor;
+
+	TBitArray<> Wall;
+
+	TBitArray<> Path;
+};
+
+// Parameters maze has been built with, compared on construction to rebuild only what they affect.
+struct FMazeBuildParameters
+{
+	FName GenerationAlgorithm;
+	int32 Seed = 0;
+	FIntVector2 Size{0, 0};
+	bool bParallelGeneration = false;
+	int32 GenerationTileSize = 0;
+
+	bool bGeneratePath = false;
+	FIntPoint PathStart{0, 0};
+	FIntPoint PathEnd{0, 0};
+
+	const UStaticMesh* FloorStaticMesh = nullptr;
+	const UStaticMesh* WallStaticMesh = nullptr;
+	const UStaticMesh* OutlineStaticMesh = nullptr;
+	const UStaticMesh* PathStaticMesh = nullptr;
+
+	bool bMergeGeometry = false;
+	int32 ChunkSize = 0;
+	int32 ChunkCullDistance = 0;
+
+	bool bUseCollision = false;
+
+	// Passages differ only if any of these parameters differ.
+	bool HasSameGeneration(const FMazeBuildParameters& Other) const;
+
+	bool HasSamePath(const FMazeBuildParameters& Other) const;
+
+	bool HasSameMeshes(const FMazeBuildParameters& Other) const;
+
+	bool HasSameLayout(const FMazeBuildParameters& Other) const;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMazeGeneratedSignature, AMaze*, Maze);
 
 UCLASS()
 class MAZEGENERATOR_API AMaze : public AActor
 {
 	GENERATED_BODY()
 
+	friend class UMazeBenchmarkCommandlet;
+
 public:
 	AMaze();
 
@@ -78,12 +209,39 @@ public:
 		meta=(NoResetToDefault, ExposeOnSpawn, DisplayPriority=0))
 	EGenerationAlgorithm GenerationAlgorithm;
 
+	/**
+	 * Name of an algorithm registered in FMazeAlgorithmRegistry, e.g. by a game module.
+	 * Overrides GenerationAlgorithm if set.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze",
+		meta=(GetOptions="GetGenerationAlgorithmNames", ExposeOnSpawn, DisplayPriority=0))
+	FName CustomGenerationAlgorithm;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze", meta=(ExposeOnSpawn, DisplayPriority=1))
 	int32 Seed;
 
 	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category="Maze", meta=(ExposeOnSpawn, DisplayPriority=2))
 	FMazeSize MazeSize;
 
+	/**
+	 * Generate maze on worker threads if the chosen algorithm supports it(Recursive Division, Sidewinder).
+	 * Binary Tree is generated the same way in both modes.
+	 * 
+	 * Result is still defined by seed only, but differs from the one generated serially.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Generation", meta=(ExposeOnSpawn))
+	bool bParallelGeneration = false;
+
+	/**
+	 * Split maze into square tiles of this size, generate them on worker threads and join into a single maze.
+	 * 0 disables tiling.
+	 * 
+	 * Result is still defined by seed and tile size only, but differs from the one generated without tiles.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Generation",
+		meta=(ExposeOnSpawn, ClampMin=0, UIMin=0, UIMax=1001))
+	int32 GenerationTileSize = 0;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, DisplayName="Floor", Category="Maze|Cells",
 		meta=(NoResetToDefault, ExposeOnSpawn, DisplayPriority=0))
 	UStaticMesh* FloorStaticMesh;
@@ -96,6 +254,29 @@ public:
 		meta=(ExposeOnSpawn, DisplayPriority=2))
 	UStaticMesh* OutlineStaticMesh;
 
+	/**
+	 * Draw each run of adjacent wall cells and the whole floor with a single scaled instance
+	 * instead of an instance per cell, which cuts instance amount several times.
+	 *
+	 * Looks the same as regular maze only for box-shaped meshes, since meshes are stretched.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Cells", meta=(ExposeOnSpawn, DisplayPriority=3))
+	bool bMergeGeometry = false;
+
+	/**
+	 * Split floor, wall and path cells into components per square region of this size, 0 disables splitting.
+	 * 
+	 * Every region gets its own bounds and culling, and only regions where cells changed are rebuilt on regeneration.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Cells",
+		meta=(ExposeOnSpawn, ClampMin=0, UIMin=0, UIMax=257, DisplayPriority=4))
+	int32 ChunkSize = 0;
+
+	// Distance at which cells of a region are culled, 0 disables culling. Used only if maze is split into regions.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Cells",
+		meta=(ExposeOnSpawn, ClampMin=0, EditCondition="ChunkSize > 0", DisplayPriority=5))
+	int32 ChunkCullDistance = 0;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Pathfinder", meta=(ExposeOnSpawn))
 	bool bGeneratePath = false;
 
@@ -107,6 +288,18 @@ public:
 		meta=(ExposeOnSpawn, EditCondition="bGeneratePath", EditConditionHides))
 	FMazeCoordinates PathEnd;
 
+	// All modes find the same path in generated(perfect) mazes, but visit different amount of cells.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Pathfinder",
+		meta=(ExposeOnSpawn, EditCondition="bGeneratePath", EditConditionHides))
+	EMazePathfindingMode PathfindingMode = EMazePathfindingMode::BidirectionalBFS;
+
+	/**
+	 * Prepare data for GetPathLength and GetPath queries during generation instead of the first query.
+	 * Takes 9 bytes per 4 maze cells.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Pathfinder", meta=(ExposeOnSpawn))
+	bool bPrecomputePathQueries = false;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, DisplayName="Path Floor", Category="Maze|Pathfinder",
 		meta=(ExposeOnSpawn, EditCondition="bGeneratePath", EditConditionHides))
 	UStaticMesh* PathStaticMesh;
@@ -115,15 +308,50 @@ public:
 		meta=(EditCondition="bGeneratePath", EditConditionHides))
 	int32 PathLength;
 
+	/**
+	 * Goal moved by MoveFlowFieldGoal at most this amount of steps away from the previous one
+	 * updates flow field incrementally instead of rebuilding it.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze|Flow Field", meta=(ClampMin=0))
+	int32 FlowFieldIncrementalDistance = 64;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Maze")
 	bool bUseCollision = true;
 
-protected:
-	TArray<TArray<uint8>> MazeGrid;
+	/**
+	 * Bake generated maze and instances of all components into BakedMazeData on save and cook,
+	 * so the maze is loaded without generation and pathfinding. Baked data is ignored once any parameter changes.
+	 */
+	UPROPERTY(EditAnywhere, Category="Maze|Baking")
+	bool bBakeMazeData = false;
+
+	// Maze baked on the last save, used instead of generation while parameters stay the same.
+	UPROPERTY(VisibleInstanceOnly, Category="Maze|Baking")
+	UMazeDataAsset* BakedMazeData;
+
+#if WITH_EDITORONLY_DATA
+	/**
+	 * While generation parameters are dragged in the details panel, draw passages of a downscaled maze
+	 * instead of regenerating it on every change. The maze is regenerated asynchronously
+	 * once the edit is committed or paused for EditorPreviewDelay seconds.
+	 */
+	UPROPERTY(EditAnywhere, Category="Maze|Editor Preview")
+	bool bEditorPreview = true;
+
+	UPROPERTY(EditAnywhere, Category="Maze|Editor Preview", meta=(ClampMin=0, EditCondition="bEditorPreview"))
+	float EditorPreviewDelay = 0.5f;
+#endif
+
+	// Broadcast every time maze instances are rebuilt.
+	UPROPERTY(BlueprintAssignable, Category="Maze")
+	FMazeGeneratedSignature OnMazeGenerated;
 
-	TArray<TArray<uint8>> MazePathGrid;
+protected:
+	// Bit-packed passages of generated maze. Expanded floor/wall grid is never stored.
+	FMazePassages MazePassages;
 
-	TMap<EGenerationAlgorithm, TSharedPtr<Algorithm>> GenerationAlgorithms;
+	// One bit per cell of expanded grid, set for cells on the path. Empty if path is not generated.
+	TBitArray<> MazePathCells;
 
 	UPROPERTY()
 	UHierarchicalInstancedStaticMeshComponent* FloorCells;
@@ -140,30 +368,150 @@ protected:
 	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category="Maze|Cells")
 	FVector2D MazeCellSize;	
 
+	// Used by path queries on the game thread.
+	FMazePathfinder Pathfinder;
+
+	// Empty until BuildFlowField or MoveFlowFieldGoal is called, reset on regeneration.
+	FMazeFlowField FlowField;
+
+	// Lowest common ancestor data of generated maze, prepared on the first path query if not precomputed.
+	FMazePathTree PathTree;
+
+	// Single chunk made of default components if maze is not split into regions.
+	UPROPERTY(Transient)
+	TArray<FMazeCellsChunk> CellChunks;
+
 public:
 	// Update Maze according to pre-set parameters: Size, Generation Algorithm, Seed and Path-related params.
 	UFUNCTION(BlueprintCallable, Category="Maze")
 	virtual void UpdateMaze();
 
+	/**
+	 * Same as UpdateMaze, but grid generation and pathfinding run on worker threads,
+	 * only components are updated on the game thread. OnMazeGenerated is broadcast when maze is ready.
+	 *
+	 * Previous pending generation is cancelled, so it's safe to call it every time parameters change.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Maze")
+	virtual void UpdateMazeAsync();
+
+	// Discards pending asynchronous generation, current maze is left as is.
+	UFUNCTION(BlueprintCallable, Category="Maze")
+	void CancelMazeGeneration();
+
+	UFUNCTION(BlueprintPure, Category="Maze")
+	bool IsGeneratingMaze() const;
+
 	/** 
 	 * Updates Maze every time any parameter has been changed(except transform).
+	 * Only the part of maze affected by changed parameters is rebuilt, see UpdateChangedMaze.
 	 * 
 	 * Remember: this method is being called before BeginPlay. 
 	 */
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Removes contribution of this maze from "stat Maze".
+	virtual void BeginDestroy() override;
+
+#if WITH_EDITOR
+	// Bakes maze data if bBakeMazeData is set.
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+	// Lets OnConstruction tell interactive edits from committed ones.
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	/**
-	 * Returns path grid mapped into MazeGrid constrains. Creates a graph every time it is called.
-	 *
-	 * Note :
-	 * 
-	 * Optimization is possible:
-	 * if the beginning or end has not changed, there is actually no need to create a new graph,
-	 * but due to the many parameters that can be changed, it is difficult to determine what exactly has changed,
-	 * so this optimization has been neglected.
+	 * Returns path grid mapped into maze grid constrains. Searches passages every time it is called,
+	 * reusing scratch buffers of previous searches.
+	 */
+	virtual FMazeGrid GetMazePath(const FMazeCoordinates& Start, const FMazeCoordinates& End, int32& OutLength);
+
+	/**
+	 * Amount of cells on path between two cells including both of them, -1 if path is not reachable.
+	 * Takes O(log n) without searching, the first query after generation prepares data in O(n).
 	 */
-	virtual TArray<TArray<uint8>> GetMazePath(const FMazeCoordinates& Start, const FMazeCoordinates& End,
-	                                          int32& OutLength);
+	UFUNCTION(BlueprintCallable, Category="Maze|Pathfinder")
+	int32 GetPathLength(const FMazeCoordinates& Start, const FMazeCoordinates& End);
+
+	/**
+	 * Cells on path from Start to End, empty if path is not reachable.
+	 * Takes O(path length) without searching, the first query after generation prepares data in O(n).
+	 */
+	UFUNCTION(BlueprintCallable, Category="Maze|Pathfinder")
+	TArray<FMazeCoordinates> GetPath(const FMazeCoordinates& Start, const FMazeCoordinates& End);
+
+	/**
+	 * Computes distance to the closest of Goals and direction towards it for every cell of maze,
+	 * so any amount of agents can query them in O(1). Large mazes are processed on worker threads.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Maze|Flow Field")
+	void BuildFlowField(const TArray<FMazeCoordinates>& Goals);
+
+	// Sets a single goal of flow field. Short moves are applied without rebuilding the whole field.
+	UFUNCTION(BlueprintCallable, Category="Maze|Flow Field")
+	void MoveFlowFieldGoal(const FMazeCoordinates& Goal);
+
+	// Steps from cell to the closest goal, -1 for walls, unreachable cells or if flow field is not built.
+	UFUNCTION(BlueprintPure, Category="Maze|Flow Field")
+	int32 GetFlowFieldDistance(const FMazeCoordinates& Cell) const;
+
+	// Next cell on the way to the closest goal. Returns Cell itself for goals, walls and unreachable cells.
+	UFUNCTION(BlueprintPure, Category="Maze|Flow Field")
+	FMazeCoordinates GetFlowFieldNextCell(const FMazeCoordinates& Cell) const;
+
+	/**
+	 * Direction per every 2x2 block of maze cells(row-major, (MazeSize + 1) / 2 blocks in a row):
+	 * 1 - East, 2 - North, 4 - South, 8 - West, 0 - goal or unreachable.
+	 */
+	UFUNCTION(BlueprintPure, Category="Maze|Flow Field")
+	TArray<uint8> GetFlowFieldDirections() const;
+
+	FORCEINLINE const FMazeFlowField& GetFlowField() const { return FlowField; }
+
+	// CustomGenerationAlgorithm if set, name of GenerationAlgorithm otherwise.
+	UFUNCTION(BlueprintPure, Category="Maze")
+	FName GetGenerationAlgorithmName() const;
+
+	// Names of all registered algorithms.
+	UFUNCTION()
+	static TArray<FName> GetGenerationAlgorithmNames();
+
+	// Writes generated maze, its path and flow field(if built) into a compact binary file.
+	UFUNCTION(BlueprintCallable, Category="Maze|File")
+	bool SaveMazeToFile(const FString& FilePath) const;
+
+	/**
+	 * Generates maze with the current size, seed and algorithm straight into a file without building it.
+	 * Eller's algorithm without parallel or tiled generation streams rows into the file,
+	 * so neither the grid nor the passages are held in memory.
+	 * The file has no path and no flow field, it is loaded with LoadMazeFromFile.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Maze|File")
+	bool GenerateMazeToFile(const FString& FilePath) const;
+
+	/**
+	 * Builds maze stored by SaveMazeToFile without generating it: the file is memory-mapped
+	 * and passages are taken from it as is. Size, seed, algorithm, generation options and path are set from the file.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Maze|File")
+	bool LoadMazeFromFile(const FString& FilePath);
+
+	// Finds path with the given pathfinder, logs a warning if path is not reachable.
+	static bool FindPath(FMazePathfinder& Pathfinder, const FMazePassages& Passages, const FMazeCoordinates& Start,
+	                     const FMazeCoordinates& End, const EMazePathfindingMode Mode, TBitArray<>& OutPathCells,
+	                     int32& OutLength);
+
+	// Returns generated grid: 1 for floor and 0 for wall cells. The grid is expanded on every call.
+	UFUNCTION(BlueprintPure, Category="Maze")
+	FMazeGrid GetMazeGrid() const;
+
+	// Returns path grid: 1 for cells on path between PathStart and PathEnd, 0 otherwise. Empty if path is not generated.
+	UFUNCTION(BlueprintPure, Category="Maze|Pathfinder")
+	FMazeGrid GetMazePathGrid() const;
+
 protected:
 	/**
 	 * Generate Maze with random size, seed and 
@@ -172,8 +520,79 @@ protected:
 	UFUNCTION(CallInEditor, Category="Maze", meta=(DisplayPriority=0, ShortTooltip = "Generate an arbitrary maze."))
 	virtual void Randomize();
 
+	// Sets meshes of components and cell size. Returns false if maze can't be created, e.g. algorithm is not registered.
+	virtual bool PrepareCells();
+
+	// Takes snapshot of current parameters.
+	virtual FMazeGenerationRequest MakeGenerationRequest();
+
+	// Thread-safe. Skips pathfinding if cancelled.
+	static FMazeGenerationResult GenerateMaze(const FMazeGenerationRequest& Request,
+	                                          const std::atomic<bool>* bCancelled = nullptr);
+
+	// Replaces current maze with the generated one and creates instances.
+	virtual void BuildMaze(FMazeGenerationResult&& Result);
+
+	/**
+	 * Compares parameters with the ones maze has been built with and takes the cheapest update:
+	 * regenerates only if generation parameters changed, searches only path if path parameters changed,
+	 * swaps meshes without moving instances unless cell size changed, or just toggles collision.
+	 * Regenerates on worker threads if bAsync is set.
+	 */
+	virtual void UpdateChangedMaze(const bool bAsync = false);
+
+	// Searches path between PathStart and PathEnd in current passages.
+	void UpdatePath();
+
+	FMazeBuildParameters GetBuildParameters() const;
+
+	// Replaces current maze with the baked one if it matches current parameters. Returns false otherwise.
+	virtual bool LoadBakedMaze();
+
+	// Hash of every parameter baked maze depends on.
+	uint32 GetBakeInputsHash() const;
+
 	virtual void CreateMazeOutline() const;
 
+	// Creates instances of all components for current maze.
+	virtual void CreateInstances();
+
+	// Creates or reuses chunks according to maze size and ChunkSize.
+	virtual void UpdateChunks();
+
+	UHierarchicalInstancedStaticMeshComponent* CreateChunkComponent(UStaticMesh* Mesh);
+
+	// Destroys components created for chunks.
+	void DestroyChunks();
+
+	// Outline component followed by floor, wall and path components of every chunk.
+	TArray<UHierarchicalInstancedStaticMeshComponent*> GetCellComponents() const;
+
+	// Thread-safe.
+	FMazeChunkCells GetChunkCells(const FMazeCellsChunk& Chunk) const;
+
+	/**
+	 * Makes floor, wall and path components have an instance per cell of the respective type.
+	 * Instances of previous maze are reused, so only cells which changed their type are updated.
+	 */
+	virtual void CreateMazeCells();
+
+	/**
+	 * Moves instances of cells not present in Cells to the added cells and adds or removes only the difference.
+	 * Starts from scratch if Slots don't describe current instances of Component.
+	 */
+	void UpdateCellInstances(UHierarchicalInstancedStaticMeshComponent* Component, const FMazeCellsChunk& Chunk,
+	                         const TBitArray<>& Cells, TArray<uint32>& Slots) const;
+
+	// Creates an instance per run of wall cells and a single floor instance(or floor runs if path is drawn).
+	virtual void CreateMergedMazeCells(const FMazeCellsChunk& Chunk) const;
+
+	// Transform which stretches mesh placed at cell (X, Y) over rectangle of RunSize cells.
+	FTransform GetMergedTransform(const UStaticMesh* Mesh, const int32 X, const int32 Y,
+	                              const FIntVector2& RunSize) const;
+
+	bool ShouldDrawPath() const;
+
 	virtual void EnableCollision(const bool bShouldEnable);
 
 	// Clears all HISM instances.
@@ -181,9 +600,57 @@ protected:
 
 	virtual FVector2D GetMaxCellSize() const;
 
+	// Updates contribution of this maze to memory and instance counters of "stat Maze".
+	void UpdateStats() const;
+
 
-#if WITH_EDITOR
 private:
+	// Set to cancel pending asynchronous generation. Null if there is none.
+	TSharedPtr<std::atomic<bool>> PendingGenerationCancelled;
+
+	// Cell size per-cell instances have been placed with.
+	FVector2D BuiltCellSize{0.f};
+
+	// Unset until maze is built and after it has been cleared.
+	TOptional<FMazeBuildParameters> BuiltParameters;
+
+#if STATS
+	static constexpr int32 ReportedStatsAmount = 7;
+
+	// Adds difference between Values and the previously reported ones to counters summed over all mazes.
+	void ReportStats(const int64 (&Values)[ReportedStatsAmount]) const;
+
+	mutable int64 ReportedStats[ReportedStatsAmount] = {};
+#endif
+
+#if WITH_EDITOR
+	// Stores current maze and transforms of all instances into BakedMazeData.
+	void BakeMazeData();
+
+	// Previews edits of generation parameters being dragged and commits the rest.
+	void UpdateEditedMaze();
+
+	// Draws passages of maze generated with current parameters, downscaled to be cheap on every change.
+	void DrawEditorPreview();
+
+	void ClearEditorPreview() const;
+
+	// Commits edit after EditorPreviewDelay unless another change comes earlier.
+	void ScheduleEditCommit();
+
+	void CommitEdit();
+
 	FTransform LastMazeTransform;
+
+	bool bEditingProperty = false;
+
+	bool bInteractiveEdit = false;
+
+	FTSTicker::FDelegateHandle EditCommitHandle;
+#endif
+
+#if WITH_EDITORONLY_DATA
+	UPROPERTY(Transient)
+	ULineBatchComponent* EditorPreviewLines;
 #endif
 };
@@ -0,0 +1,44 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "Algorithms/Algorithm.h"
+
+enum class EGenerationAlgorithm : uint8;
+
+/**
+ * Process-wide algorithms keyed by name, shared by all mazes and all threads.
+ *
+ * Built-in algorithms are registered on first access under names of EGenerationAlgorithm values(e.g. "Eller").
+ * Game modules may register their own Algorithm subclasses(e.g. in StartupModule) under new names,
+ * which mazes select with CustomGenerationAlgorithm, or under built-in names to replace them. Thread-safe.
+ */
+class MAZEGENERATOR_API FMazeAlgorithmRegistry
+{
+public:
+	static FMazeAlgorithmRegistry& Get();
+
+	// Name the built-in algorithm is registered under.
+	static FName GetBuiltInName(const EGenerationAlgorithm BuiltInAlgorithm);
+
+	// Null if nothing is registered for the key.
+	TSharedPtr<const Algorithm> Find(const FName Key) const;
+
+	bool Contains(const FName Key) const;
+
+	// Replaces algorithm registered for the key, if any. Generations already running keep the previous one.
+	void Register(const FName Key, const TSharedRef<const Algorithm>& InAlgorithm);
+
+	void Unregister(const FName Key);
+
+	TArray<FName> GetKeys() const;
+
+private:
+	FMazeAlgorithmRegistry();
+
+	mutable FRWLock Lock;
+
+	TMap<FName, TSharedRef<const Algorithm>> Algorithms;
+};
@@ -0,0 +1,61 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "MazeBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of maze generation, path search and instance construction for every generation algorithm.
+ *
+ * UnrealEditor-Cmd <Project> -run=MazeBenchmark -nullrhi -unattended
+ *     [-Algorithms=Backtracker+Kruskal] [-Sizes=101+501+1001] [-Iterations=5]
+ *     [-Output=<File>.csv|<File>.json] [-Baseline=<File>.json] [-Tolerance=0.1] [-MinDeltaMs=0.5]
+ *
+ * Every phase is timed separately and the median of iterations is reported.
+ * Returns 1 if any phase is slower than in the baseline by more than Tolerance(relative) and MinDeltaMs(absolute).
+ */
+UCLASS()
+class MAZEGENERATOR_API UMazeBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMazeBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FBenchmarkResult
+	{
+		FString Algorithm;
+
+		int32 Size = 0;
+
+		// Milliseconds.
+		double GenerationTime = 0.0;
+
+		double ExpansionTime = 0.0;
+
+		double PathTime = 0.0;
+
+		double InstancesTime = 0.0;
+
+		int64 PassagesBytes = 0;
+
+		int32 Instances = 0;
+
+		// Peak of memory held by passages, grid, path, pathfinder and instance data during a single iteration.
+		int64 PeakMemoryBytes = 0;
+	};
+
+	static FString ToCSV(const TArray<FBenchmarkResult>& Results);
+
+	static FString ToJSON(const TArray<FBenchmarkResult>& Results);
+
+	// Returns amount of phases slower than in baseline by more than Tolerance and MinDelta milliseconds.
+	static int32 CompareWithBaseline(const TArray<FBenchmarkResult>& Results, const FString& BaselineJSON,
+	                                 const double Tolerance, const double MinDelta);
+};
@@ -0,0 +1,63 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+
+#include "MazePassages.h"
+
+#include "MazeDataAsset.generated.h"
+
+// Instances of a single chunk of maze cells, in the order they are added to components.
+struct FMazeBakedChunk
+{
+	TArray<FTransform> FloorTransforms;
+
+	TArray<FTransform> WallTransforms;
+
+	TArray<FTransform> PathTransforms;
+
+	friend FArchive& operator<<(FArchive& Ar, FMazeBakedChunk& Chunk)
+	{
+		return Ar << Chunk.FloorTransforms << Chunk.WallTransforms << Chunk.PathTransforms;
+	}
+};
+
+/**
+ * Generated maze baked on save or cook, so it is loaded without generation and pathfinding.
+ *
+ * Holds passages, path and ready-to-submit instance transforms of every component.
+ * Bulk data is serialized as raw arrays instead of tagged properties.
+ */
+UCLASS()
+class MAZEGENERATOR_API UMazeDataAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Serialize(FArchive& Ar) override;
+
+	FMazePassages GetPassages() const;
+
+	TBitArray<> GetPathCells() const;
+
+	// Hash of maze parameters the data has been baked with. Baked data is used only if parameters are the same.
+	UPROPERTY(VisibleAnywhere, Category="Maze")
+	uint32 InputsHash = 0;
+
+	UPROPERTY(VisibleAnywhere, Category="Maze")
+	FIntPoint MazeSize{0, 0};
+
+	UPROPERTY(VisibleAnywhere, Category="Maze")
+	int32 PathLength = 0;
+
+	TArray<uint64> PassageWords;
+
+	// Bits of path cells, empty if path is not generated.
+	TArray<uint32> PathWords;
+
+	TArray<FTransform> OutlineTransforms;
+
+	TArray<FMazeBakedChunk> Chunks;
+};
@@ -0,0 +1,191 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MazePassages.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Header of binary maze file. All data is little-endian and stored as is in memory,
+ * so a mapped file is used without parsing:
+ *
+ * header(64 bytes) | passage words(uint64) | [path bits(uint32 words)] | [distances(int32)] [directions(uint8)]
+ *
+ * Path block holds a bit per cell of expanded grid, distance block holds flow field per directions grid cell.
+ */
+struct FMazeFileHeader
+{
+	static constexpr uint32 MagicNumber = 0x455A414D; // "MAZE"
+
+	static constexpr uint16 CurrentVersion = 1;
+
+	// Algorithm of mazes generated with CustomGenerationAlgorithm, whose name doesn't fit into the header.
+	static constexpr uint8 CustomAlgorithm = MAX_uint8;
+
+	enum EFlags : uint16
+	{
+		HasPath = 1 << 0,
+		HasDistances = 1 << 1,
+		// Maze has been generated with FGenerationOptions::bParallel.
+		ParallelGeneration = 1 << 2,
+	};
+
+	uint32 Magic = MagicNumber;
+
+	uint16 Version = CurrentVersion;
+
+	uint16 Flags = 0;
+
+	// Size of expanded grid.
+	int32 SizeX = 0;
+
+	int32 SizeY = 0;
+
+	int32 Seed = 0;
+
+	// EGenerationAlgorithm the maze has been generated with or CustomAlgorithm.
+	uint8 Algorithm = 0;
+
+	uint8 Reserved[3] = {};
+
+	float CellSizeX = 0.f;
+
+	float CellSizeY = 0.f;
+
+	// Amount of cells on the stored path.
+	int32 PathLength = 0;
+
+	// Offsets of blocks from the beginning of the file, 0 for absent blocks.
+	uint32 PassagesOffset = 0;
+
+	uint32 PathOffset = 0;
+
+	uint32 DistancesOffset = 0;
+
+	uint32 DirectionsOffset = 0;
+
+	// Tile size in maze cells the maze has been generated with, 0 if not tiled.
+	int32 GenerationTileSize = 0;
+
+	uint8 Padding[8] = {};
+};
+
+static_assert(sizeof(FMazeFileHeader) == 64, "Maze file header layout must not change.");
+
+// Optional blocks and parameters written along with passages.
+struct FMazeFileContent
+{
+	int32 Seed = 0;
+
+	uint8 Algorithm = 0;
+
+	// Generation options needed to generate the same maze from seed and algorithm.
+	bool bParallelGeneration = false;
+
+	int32 GenerationTileSize = 0;
+
+	FVector2D CellSize{0.f};
+
+	// One bit per cell of expanded grid, not written if empty.
+	const TBitArray<>* PathCells = nullptr;
+
+	int32 PathLength = 0;
+
+	// Flow field per directions grid cell, not written if empty.
+	TArrayView<const int32> Distances;
+
+	TArrayView<const uint8> Directions;
+};
+
+class MAZEGENERATOR_API FMazeFileWriter
+{
+public:
+	static bool Write(const FString& Path, const FMazePassages& Passages, const FMazeFileContent& Content);
+};
+
+/**
+ * Writes passages row by row as they are generated, so only one row of directions is held in memory.
+ * Only the passages block is written, path and flow field blocks of the content are ignored.
+ */
+class MAZEGENERATOR_API FMazeFileRowWriter
+{
+public:
+	// Writes the header. Returns false if the file can't be created.
+	bool Open(const FString& Path, const FIntVector2& MazeSize, const FMazeFileContent& Content);
+
+	// Packs directions of the next row of directions grid, as produced by algorithms.
+	void WriteRow(TArrayView<const uint8> Directions);
+
+	// Returns false if not all rows have been written or writing has failed.
+	bool Close();
+
+private:
+	TUniquePtr<FArchive> Writer;
+
+	int32 Width = 0;
+
+	int32 RowsLeft = 0;
+
+	// Bits not yet written.
+	uint64 Word = 0;
+
+	int32 WordBits = 0;
+};
+
+/**
+ * Reads maze file by mapping it into memory. All accessors point into the mapped file,
+ * which stays mapped until the reader is destroyed. Falls back to loading the file
+ * if memory mapping is not supported by the platform.
+ */
+class MAZEGENERATOR_API FMazeFileReader
+{
+public:
+	FMazeFileReader();
+
+	~FMazeFileReader();
+
+	// Maps file and validates its layout and content. Returns false if file is missing or malformed.
+	bool Open(const FString& Path);
+
+	void Close();
+
+	FORCEINLINE bool IsOpen() const { return Data != nullptr; }
+
+	FORCEINLINE const FMazeFileHeader& GetHeader() const { return *reinterpret_cast<const FMazeFileHeader*>(Data); }
+
+	TArrayView<const uint64> GetPassageWords() const;
+
+	// Passages are copied from the file as a single block.
+	FMazePassages GetPassages() const;
+
+	FORCEINLINE bool HasPath() const { return GetHeader().Flags & FMazeFileHeader::HasPath; }
+
+	TBitArray<> GetPathCells() const;
+
+	FORCEINLINE bool HasDistances() const { return GetHeader().Flags & FMazeFileHeader::HasDistances; }
+
+	TArrayView<const int32> GetDistances() const;
+
+	TArrayView<const uint8> GetDirections() const;
+
+private:
+	// Checks that passages stay within the maze and flow field directions follow open passages.
+	bool IsContentValid() const;
+
+	int32 GetDirectionsCellsAmount() const;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Used if file can't be mapped.
+	TArray64<uint8> Buffer;
+
+	const uint8* Data = nullptr;
+
+	int64 DataSize = 0;
+};
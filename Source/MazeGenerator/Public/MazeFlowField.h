@@ -0,0 +1,75 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MazePassages.h"
+
+/**
+ * Distance to the closest goal and direction of the next step towards it for every cell of a maze.
+ *
+ * Field is stored per directions grid cell(4 times fewer than cells of expanded grid) and sampled
+ * in expanded grid coordinates in O(1), so any amount of agents can share it.
+ * Directions use the same bits as generation algorithms: 1 - East, 2 - North, 4 - South, 8 - West, 0 - none.
+ */
+class MAZEGENERATOR_API FMazeFlowField
+{
+public:
+	FORCEINLINE bool IsEmpty() const { return Distances.IsEmpty(); }
+
+	/**
+	 * Computes field towards the closest of Goals(cells of expanded grid), goals on walls are ignored.
+	 * Large wavefronts are expanded on worker threads if bParallel is set.
+	 */
+	void Build(const FMazePassages& InPassages, TArrayView<const FIntPoint> Goals, const bool bParallel);
+
+	/**
+	 * Replaces goals with a single one. If the field was built for a single cell of a perfect maze
+	 * and the new goal is at most MaxIncrementalDistance steps away, only directions on path between goals
+	 * are reversed and distances are patched in one linear pass without search. Rebuilds the field otherwise.
+	 */
+	void MoveGoal(const FIntPoint& Goal, const int32 MaxIncrementalDistance, const bool bParallel);
+
+	// Restores previously computed field, e.g. stored in a file. Moving goal afterwards rebuilds the field.
+	void Assign(const FMazePassages& InPassages, TArrayView<const int32> InDistances,
+	            TArrayView<const uint8> InDirections);
+
+	// Steps from cell of expanded grid to the closest goal, INDEX_NONE for walls and unreachable cells.
+	int32 GetDistance(const FIntPoint& Cell) const;
+
+	// Offset to the next cell of expanded grid on the way to the closest goal, zero for goals, walls and unreachable cells.
+	FIntPoint GetNextStep(const FIntPoint& Cell) const;
+
+	// Direction bits per directions grid cell, row-major.
+	FORCEINLINE TArrayView<const uint8> GetDirections() const { return Directions; }
+
+	// Distances in expanded grid steps per directions grid cell, row-major.
+	FORCEINLINE TArrayView<const int32> GetDistances() const { return Distances; }
+
+	SIZE_T GetAllocatedSize() const;
+
+	void Empty();
+
+private:
+	// Expands one level of the wavefront, appending cells at Distance + 2 to OutNext.
+	void ExpandLevel(const TArray<int32>& Frontier, const int32 Distance, const bool bParallel,
+	                 TArray<int32>& OutNext);
+
+	// Directions grid cell neighbouring passage cell of expanded grid from the west or the north, and the other one.
+	void GetPassageCells(const FIntPoint& Cell, int32& OutFirst, int32& OutSecond) const;
+
+	FMazePassages Passages;
+
+	TArray<int32> Distances;
+
+	TArray<uint8> Directions;
+
+	// Reached cells in order of non-decreasing distance, so every cell goes after the one it leads to.
+	TArray<int32> Order;
+
+	// Set if passages form a tree and the field was built for a single goal on a directions grid cell.
+	bool bIncremental = false;
+
+	int32 GoalNode = INDEX_NONE;
+};
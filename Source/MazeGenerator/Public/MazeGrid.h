@@ -0,0 +1,96 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "MazeGrid.generated.h"
+
+/**
+ * Contiguous row-major grid of cells.
+ *
+ * All rows share one buffer, so creating a grid is a single allocation
+ * and accessing a cell is an index computation instead of a pointer chase.
+ */
+USTRUCT(BlueprintType)
+struct MAZEGENERATOR_API FMazeGrid
+{
+	GENERATED_BODY()
+
+	FMazeGrid();
+
+	// Creates zeroed grid.
+	FMazeGrid(const int32 InWidth, const int32 InHeight);
+
+	explicit FMazeGrid(const FIntVector2& Size);
+
+	FORCEINLINE int32 GetWidth() const { return Width; }
+
+	FORCEINLINE int32 GetHeight() const { return Height; }
+
+	// Distance in cells between the beginnings of two adjacent rows.
+	FORCEINLINE int32 GetStride() const { return Stride; }
+
+	FORCEINLINE bool IsEmpty() const { return Cells.IsEmpty(); }
+
+	FORCEINLINE bool IsValidIndex(const int32 X, const int32 Y) const
+	{
+		return X >= 0 && Y >= 0 && X < Width && Y < Height;
+	}
+
+	FORCEINLINE int32 ToIndex(const int32 X, const int32 Y) const { return Y * Stride + X; }
+
+	FORCEINLINE uint8& operator()(const int32 X, const int32 Y) { return Cells[ToIndex(X, Y)]; }
+
+	FORCEINLINE uint8 operator()(const int32 X, const int32 Y) const { return Cells[ToIndex(X, Y)]; }
+
+	// Row view, so cells can still be accessed as Grid[Y][X].
+	FORCEINLINE TArrayView<uint8> operator[](const int32 Y)
+	{
+		return TArrayView<uint8>(Cells.GetData() + Y * Stride, Width);
+	}
+
+	FORCEINLINE TArrayView<const uint8> operator[](const int32 Y) const
+	{
+		return TArrayView<const uint8>(Cells.GetData() + Y * Stride, Width);
+	}
+
+	FORCEINLINE const TArray<uint8>& GetCells() const { return Cells; }
+
+	SIZE_T GetAllocatedSize() const;
+
+	// Releases the buffer.
+	void Empty();
+
+private:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Maze", meta=(AllowPrivateAccess=true))
+	int32 Width;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Maze", meta=(AllowPrivateAccess=true))
+	int32 Height;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Maze", meta=(AllowPrivateAccess=true))
+	int32 Stride;
+
+	UPROPERTY(BlueprintReadOnly, Category="Maze", meta=(AllowPrivateAccess=true))
+	TArray<uint8> Cells;
+};
+
+// Blueprint accessors for FMazeGrid.
+UCLASS()
+class MAZEGENERATOR_API UMazeGridLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category="Maze|Grid")
+	static int32 GetGridWidth(const FMazeGrid& Grid);
+
+	UFUNCTION(BlueprintPure, Category="Maze|Grid")
+	static int32 GetGridHeight(const FMazeGrid& Grid);
+
+	// Returns 0 for cells outside the grid.
+	UFUNCTION(BlueprintPure, Category="Maze|Grid")
+	static uint8 GetGridCell(const FMazeGrid& Grid, const int32 X, const int32 Y);
+};
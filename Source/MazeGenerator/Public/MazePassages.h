@@ -0,0 +1,102 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MazeGrid.h"
+
+/**
+ * Bit-packed passages of a maze.
+ *
+ * Stores only East and South passage bits for every cell of the directions grid(2 bits per cell),
+ * West and North passages are read from the neighbouring cells.
+ *
+ * The expanded floor/wall grid never has to be materialized: IsFloor answers queries in its coordinates,
+ * where cell (X, Y) is located at (X * 2, Y * 2) and passages are located between cells.
+ */
+struct MAZEGENERATOR_API FMazePassages
+{
+	FMazePassages();
+
+	// Creates passages without any open passage for maze of the given(expanded) size.
+	explicit FMazePassages(const FIntVector2& InMazeSize);
+
+	// Creates passages from bit-packed words, e.g. stored in a file. Words are copied as a single block.
+	FMazePassages(const FIntVector2& InMazeSize, TArrayView<const uint64> InWords);
+
+	// Width of directions grid.
+	FORCEINLINE int32 GetWidth() const { return Width; }
+
+	// Height of directions grid.
+	FORCEINLINE int32 GetHeight() const { return Height; }
+
+	// Size of expanded floor/wall grid.
+	FORCEINLINE FIntVector2 GetMazeSize() const { return MazeSize; }
+
+	FORCEINLINE bool IsEmpty() const { return Words.IsEmpty(); }
+
+	FORCEINLINE int32 ToIndex(const int32 X, const int32 Y) const { return Y * Width + X; }
+
+	FORCEINLINE bool HasEast(const int32 X, const int32 Y) const { return GetBit(ToIndex(X, Y) * 2); }
+
+	FORCEINLINE bool HasSouth(const int32 X, const int32 Y) const { return GetBit(ToIndex(X, Y) * 2 + 1); }
+
+	FORCEINLINE bool HasWest(const int32 X, const int32 Y) const { return X > 0 && HasEast(X - 1, Y); }
+
+	FORCEINLINE bool HasNorth(const int32 X, const int32 Y) const { return Y > 0 && HasSouth(X, Y - 1); }
+
+	FORCEINLINE void OpenEast(const int32 X, const int32 Y) { SetBit(ToIndex(X, Y) * 2); }
+
+	FORCEINLINE void OpenSouth(const int32 X, const int32 Y) { SetBit(ToIndex(X, Y) * 2 + 1); }
+
+	// Whether cell of expanded grid is a floor.
+	FORCEINLINE bool IsFloor(const int32 MazeX, const int32 MazeY) const
+	{
+		if (MazeX < 0 || MazeY < 0 || MazeX >= MazeSize.X || MazeY >= MazeSize.Y)
+		{
+			return false;
+		}
+		const bool bOddX = MazeX & 1;
+		const bool bOddY = MazeY & 1;
+		if (bOddX && bOddY)
+		{
+			return false;
+		}
+		if (bOddX)
+		{
+			return HasEast(MazeX / 2, MazeY / 2);
+		}
+		if (bOddY)
+		{
+			return HasSouth(MazeX / 2, MazeY / 2);
+		}
+		return true;
+	}
+
+	// Amount of open passages, so amount of floor cells of expanded grid is Width * Height + CountPassages().
+	int32 CountPassages() const;
+
+	// Expands passages into floor/wall grid: 1 for floor and 0 for wall. Allocates a byte per cell.
+	FMazeGrid ToGrid() const;
+
+	FORCEINLINE const TArray<uint64>& GetWords() const { return Words; }
+
+	SIZE_T GetAllocatedSize() const;
+
+	// Releases the buffer.
+	void Empty();
+
+private:
+	FORCEINLINE bool GetBit(const int32 Bit) const { return Words[Bit >> 6] >> (Bit & 63) & 1; }
+
+	FORCEINLINE void SetBit(const int32 Bit) { Words[Bit >> 6] |= uint64(1) << (Bit & 63); }
+
+	int32 Width;
+
+	int32 Height;
+
+	FIntVector2 MazeSize;
+
+	TArray<uint64> Words;
+};
@@ -0,0 +1,74 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MazePassages.h"
+
+/**
+ * Answers path queries on perfect mazes without searching.
+ *
+ * Passages of a perfect maze form a spanning tree, so path between two cells is unique
+ * and goes through their lowest common ancestor. The tree is rooted once in O(n) and split into heavy paths,
+ * after which the ancestor is found in O(log n), path length is computed from depths,
+ * and path itself is walked in O(path length).
+ *
+ * Stores 9 bytes per directions grid cell. Mazes with several components are supported,
+ * cells of different components are reported unreachable.
+ */
+class MAZEGENERATOR_API FMazePathTree
+{
+public:
+	FMazePathTree() = default;
+
+	explicit FMazePathTree(const FMazePassages& Passages);
+
+	FORCEINLINE bool IsEmpty() const { return Depths.IsEmpty(); }
+
+	/**
+	 * Amount of cells of expanded grid on path between two cells of expanded grid, including both of them.
+	 * Returns INDEX_NONE if any of them is a wall or they are not connected.
+	 */
+	int32 GetPathLength(const FIntPoint& Start, const FIntPoint& End) const;
+
+	// Cells of expanded grid on path from Start to End. Returns false if path is not reachable.
+	bool GetPath(const FIntPoint& Start, const FIntPoint& End, TArray<FIntPoint>& OutPath) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	void Empty();
+
+private:
+	// Directions grid cell and amount of expanded grid steps from a point to it.
+	struct FAnchor
+	{
+		int32 Node;
+
+		int32 Steps;
+	};
+
+	// One anchor for cells, two for passages, none for walls. Returns amount of anchors.
+	int32 GetAnchors(const FIntPoint& Point, FAnchor (&OutAnchors)[2]) const;
+
+	// Finds the closest pair of anchors. Returns amount of expanded grid steps between points or INDEX_NONE.
+	int32 FindClosestAnchors(const FIntPoint& Start, const FIntPoint& End, int32& OutStartNode,
+	                         int32& OutEndNode) const;
+
+	// Lowest common ancestor, INDEX_NONE if nodes are in different trees.
+	int32 FindAncestor(int32 First, int32 Second) const;
+
+	int32 GetParent(const int32 Node) const;
+
+	FIntVector2 MazeSize{0, 0};
+
+	int32 Width = 0;
+
+	// Direction to the parent of each cell, None for roots.
+	TArray<uint8> Parents;
+
+	TArray<int32> Depths;
+
+	// Topmost cell of the heavy path each cell belongs to.
+	TArray<int32> Heads;
+};
@@ -0,0 +1,92 @@
+// Copyright LowkeyMe. All Rights Reserved. 2022
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MazePassages.h"
+
+#include "MazePathfinder.generated.h"
+
+UENUM(BlueprintType)
+enum class EMazePathfindingMode : uint8
+{
+	BFS UMETA(DisplayName="Breadth-First Search"),
+	BidirectionalBFS UMETA(DisplayName="Bidirectional Breadth-First Search"),
+	AStar UMETA(DisplayName="A*")
+};
+
+/**
+ * Finds paths directly over bit-packed passages.
+ *
+ * Search runs over directions grid cells, which are 4 times fewer than cells of expanded grid,
+ * and stops as soon as the end is reached. Scratch buffers are kept between searches,
+ * so repeated queries on the same maze don't allocate and don't clear per-cell data.
+ *
+ * Not thread-safe: use a separate pathfinder per thread.
+ */
+class MAZEGENERATOR_API FMazePathfinder
+{
+public:
+	/**
+	 * Finds path between cells of expanded grid, the result is written as one bit per cell of expanded grid.
+	 * Returns false if path is not reachable.
+	 */
+	bool FindPath(const FMazePassages& Passages, const FIntPoint& Start, const FIntPoint& End,
+	              const EMazePathfindingMode Mode, TBitArray<>& OutPathCells, int32& OutLength);
+
+	SIZE_T GetAllocatedSize() const;
+
+	// Releases scratch buffers.
+	void Empty();
+
+private:
+	struct FOpenNode
+	{
+		// Cost plus heuristic.
+		int32 Estimate;
+
+		int32 Cost;
+
+		int32 Node;
+
+		// Deeper nodes go first among equally estimated ones.
+		bool operator<(const FOpenNode& Other) const
+		{
+			return Estimate < Other.Estimate || (Estimate == Other.Estimate && Cost > Other.Cost);
+		}
+	};
+
+	// Prepares marks for a new search and returns mark of forward search, backward search uses the next one.
+	uint32 BeginSearch(const int32 NodesAmount);
+
+	bool SearchBFS(const FMazePassages& Passages, const int32 StartNode, const int32 EndNode);
+
+	bool SearchBidirectionalBFS(const FMazePassages& Passages, const int32 StartNode, const int32 EndNode);
+
+	bool SearchAStar(const FMazePassages& Passages, const int32 StartNode, const int32 EndNode);
+
+	// Appends nodes from Node to the root of its search, following parents.
+	void AppendChain(const FMazePassages& Passages, int32 Node, const int32 Root);
+
+	// Search which visited each node, valid only if equal to the current mark(forward) or the next one(backward).
+	TArray<uint32> Marks;
+
+	uint32 Mark = 0;
+
+	// Direction to the parent of each visited node.
+	TArray<uint8> Parents;
+
+	// Distance from start, used by A* only.
+	TArray<int32> Costs;
+
+	TArray<int32> Queue;
+
+	TArray<int32> BackwardQueue;
+
+	// Binary heap of A*.
+	TArray<FOpenNode> OpenNodes;
+
+	// Nodes of found path from start to end.
+	TArray<int32> NodePath;
+};